@@ -0,0 +1,65 @@
+/**
+ * @file Arduino.cpp
+ * @author
+ * @brief Host implementation of the Arduino timing functions and of Serial on stdin/stdout.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+
+static const auto start = std::chrono::steady_clock::now();
+
+uint32_t millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+  while (std::chrono::steady_clock::now() < end);
+}
+
+void yield() {
+}
+
+/**
+ * @brief Number of bytes which can be read without blocking, 0 or 1 on a host.
+ * @return int
+ */
+int HardwareSerial::available() {
+  if (peeked >= 0) return 1;
+  pollfd input {STDIN_FILENO, POLLIN, 0};
+  if (::poll(&input, 1, 0) <= 0 || !(input.revents & POLLIN)) return 0;
+  unsigned char c;
+  if (::read(STDIN_FILENO, &c, 1) != 1) return 0;
+  peeked = c;
+  return 1;
+}
+
+int HardwareSerial::read() {
+  if (!available()) return -1;
+  int c = peeked;
+  peeked = -1;
+  return c;
+}
+
+int HardwareSerial::peek() {
+  return available() ? peeked : -1;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file Arduino.h
+ * @author
+ * @brief Minimal Arduino core for host (Linux) builds of the battery reader.
+ * Only the parts used by this project are provided: String, Print/Stream, Serial on stdin/stdout, the timing
+ * functions and the PROGMEM helpers (which are no-ops on a host).
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#if defined(ARDUINO)
+#error "host/Arduino.h is for host builds only"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+#define HEX 16
+#define DEC 10
+#define OCT 8
+#define BIN 2
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+// Program memory does not exist on a host, everything is plain memory.
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+#define F(s) FPSTR(PSTR(s))
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(void * const *)(addr))
+#define strcmp_P strcmp
+#define strcasecmp_P strcasecmp
+#define strncasecmp_P strncasecmp
+#define strlen_P strlen
+#define memcpy_P memcpy
+class __FlashStringHelper;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+class String {
+public:
+  String(const char *s = "") : s_(s ? s : "") {}
+  String(const std::string &s) : s_(s) {}
+  String(const __FlashStringHelper *s) : s_(reinterpret_cast<const char *>(s)) {}
+  String(char c) : s_(1, c) {}
+  String(int v, unsigned char base = DEC) : s_(number(v, base)) {}
+  String(unsigned int v, unsigned char base = DEC) : s_(number(v, base)) {}
+  String(long v, unsigned char base = DEC) : s_(number(v, base)) {}
+  String(unsigned long v, unsigned char base = DEC) : s_(number(v, base)) {}
+  unsigned int length() const { return s_.length(); }
+  const char *c_str() const { return s_.c_str(); }
+  char charAt(unsigned int i) const { return i < s_.length() ? s_[i] : 0; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+  bool equals(const String &o) const { return s_ == o.s_; }
+  bool equalsIgnoreCase(const String &o) const { return strcasecmp(c_str(), o.c_str()) == 0; }
+  bool startsWith(const String &o) const { return s_.compare(0, o.s_.length(), o.s_) == 0; }
+  String substring(unsigned int from) const { return from < s_.length() ? String(s_.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const { return from < s_.length() ? String(s_.substr(from, to - from)) : String(); }
+  int indexOf(char c) const { auto p = s_.find(c); return p == std::string::npos ? -1 : (int)p; }
+  void toLowerCase() { for (auto &c : s_) c = tolower(c); }
+  void toUpperCase() { for (auto &c : s_) c = toupper(c); }
+  void trim() { while (!s_.empty() && isspace(s_.back())) s_.pop_back(); s_.erase(0, s_.find_first_not_of(" \t\r\n") == std::string::npos ? s_.length() : s_.find_first_not_of(" \t\r\n")); }
+  String &operator+=(const String &o) { s_ += o.s_; return *this; }
+  String &operator+=(const char *o) { s_ += o; return *this; }
+  String &operator+=(char c) { s_ += c; return *this; }
+  bool concat(const String &o) { s_ += o.s_; return true; }
+  friend String operator+(const String &a, const String &b) { return String(a.s_ + b.s_); }
+  friend String operator+(const String &a, const char *b) { return String(a.s_ + b); }
+  friend String operator+(const char *a, const String &b) { return String(a + b.s_); }
+  bool operator==(const String &o) const { return s_ == o.s_; }
+  bool operator==(const char *o) const { return s_ == o; }
+  bool operator!=(const String &o) const { return s_ != o.s_; }
+  bool operator!=(const char *o) const { return s_ != o; }
+  bool operator<(const String &o) const { return s_ < o.s_; }
+
+private:
+  template <typename T>
+  static std::string number(T v, unsigned char base) {
+    if (base == DEC) return std::to_string(v);
+    std::string out;
+    unsigned long long u = (unsigned long long)(typename std::make_unsigned<T>::type)v;
+    do { out.insert(out.begin(), "0123456789ABCDEF"[u % base]); u /= base; } while (u);
+    return out;
+  }
+  std::string s_;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+  size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+  size_t print(const String &s) { return write(s.c_str()); }
+  size_t print(const char s[]) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char v, int base = DEC) { return printNumber((unsigned long)v, base); }
+  size_t print(int v, int base = DEC) { return printSigned(v, base); }
+  size_t print(unsigned int v, int base = DEC) { return printNumber((unsigned long)v, base); }
+  size_t print(long v, int base = DEC) { return printSigned(v, base); }
+  size_t print(unsigned long v, int base = DEC) { return printNumber(v, base); }
+  size_t print(long long v, int base = DEC) { return printSigned((long)v, base); }
+  size_t print(unsigned long long v, int base = DEC) { return printNumber((unsigned long)v, base); }
+  size_t print(double v, int digits = 2) {
+    char buffer[40];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, v);
+    return write(buffer);
+  }
+
+  template <typename T>
+  size_t println(const T &v) { size_t n = print(v); return n + println(); }
+  template <typename T>
+  size_t println(const T &v, int format) { size_t n = print(v, format); return n + println(); }
+  size_t println() { return write("\r\n"); }
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+    char buffer[128];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return n > 0 ? write((const uint8_t *)buffer, std::min<size_t>(n, sizeof(buffer) - 1)) : 0;
+  }
+
+private:
+  size_t printSigned(long v, int base) {
+    if (base == DEC && v < 0) return write('-') + printNumber((unsigned long)(-v), base);
+    return printNumber((unsigned long)v, base);
+  }
+  size_t printNumber(unsigned long v, int base) {
+    char buffer[8 * sizeof(long) + 1];
+    char *p = &buffer[sizeof(buffer) - 1];
+    *p = '\0';
+    if (base < 2) base = 10;
+    do { *--p = "0123456789ABCDEF"[v % base]; v /= base; } while (v);
+    return write(p);
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long) {}
+};
+
+/**
+ * @brief Serial port of the host: output goes to stdout, input comes from stdin (non blocking).
+ */
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+  size_t write(const uint8_t *buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+  void flush() override { fflush(stdout); }
+  operator bool() { return true; }
+  using Print::write;
+
+private:
+  int peeked {-1};
+};
+
+extern HardwareSerial Serial;
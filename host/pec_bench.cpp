@@ -0,0 +1,78 @@
+/**
+ * @file pec_bench.cpp
+ * @author
+ * @brief Host benchmark of the SMBus packet error code.
+ * Measures the table driven CRC-8 against a bitwise one, and reads words from the simulated battery with and without
+ * PEC: host time and bus time per read, and how many corrupted words get through.
+ *
+ * Build: g++ -std=gnu++2a -O2 -Ihost -o pec_bench host/pec_bench.cpp host/Arduino.cpp $(find lib -name '*.cpp')
+ * Run:   ./pec_bench [reads] [corrupt rate in permille]
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <Arduino.h>
+#include "../lib/SMB/SMBPec.h"
+#include "../lib/SMB/SimTransport.h"
+
+// reference: one bit at a time
+static uint8_t bitwise(uint8_t crc, const uint8_t* data, uint32_t length) {
+  for (uint32_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) crc = crc & 0x80 ? (crc << 1) ^ SMBPECPOLYNOMIAL : crc << 1;
+  }
+  return crc;
+}
+
+static void crcThroughput() {
+  static uint8_t data[4096];
+  for (uint32_t i = 0; i < sizeof(data); i++) data[i] = i * 31 + 7;
+  const uint32_t rounds = 2000;
+  volatile uint8_t sink = 0;
+
+  uint32_t start = micros();
+  for (uint32_t r = 0; r < rounds; r++) {
+    uint8_t crc = 0;
+    for (uint32_t i = 0; i < sizeof(data); i += 255) crc = smbpec(crc, data + i, sizeof(data) - i < 255 ? sizeof(data) - i : 255);
+    sink = sink ^ crc;
+  }
+  uint32_t table = micros() - start;
+
+  start = micros();
+  for (uint32_t r = 0; r < rounds; r++) sink = sink ^ bitwise(0, data, sizeof(data));
+  uint32_t bits = micros() - start;
+
+  const uint8_t check[] {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  fprintf(stderr, "CRC-8 check value 0x%02x (expected 0xf4), bitwise 0x%02x\n", smbpec(0, check, 9), bitwise(0, check, 9));
+  double bytes = (double)rounds * sizeof(data);
+  fprintf(stderr, "%-10s %10.1f MB/s\n%-10s %10.1f MB/s\n", "table", bytes / table, "bitwise", bytes / bits);
+}
+
+static void wordReads(bool pec, uint32_t reads, uint16_t corruptrate) {
+  simbattery battery;
+  battery.setPec(pec);
+  battery.setCorruptRate(corruptrate);
+  uint32_t errors = 0, wrong = 0;
+  uint16_t data;
+  uint32_t start = micros();
+  for (uint32_t i = 0; i < reads; i++) {
+    if (battery.readWord(SIMADDRESS, 0x18, data)) errors++;  // designCapacity, a constant
+    else if (data != 4400) wrong++;
+  }
+  uint32_t elapsed = micros() - start;
+  fprintf(stderr, "%-8s %10.1f ns/read %10.1f bus us/read %10u corrupted %10u PEC errors %10u wrong words accepted\n",
+          pec ? "PEC" : "no PEC", elapsed * 1000.0 / reads, (double)battery.simulatedMicros() / reads, battery.corruptions(),
+          errors, wrong);
+}
+
+int main(int argc, char** argv) {
+  uint32_t reads = argc > 1 ? strtoul(argv[1], nullptr, 0) : 1000000;
+  uint16_t corruptrate = argc > 2 ? strtoul(argv[2], nullptr, 0) : 1;
+  crcThroughput();
+  wordReads(false, reads, corruptrate);
+  wordReads(true, reads, corruptrate);
+  return 0;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file session_tool.cpp
+ * @author
+ * @brief Host tool for the bus sessions of command 15 (lib/logger/session.h).
+ * record: runs a fixed set of commands against the simulated battery and records the session.
+ * import: turns the '15 d' download in a serial capture (x,<offset>,<hex> lines) back into a session file.
+ * dump:   prints the transactions of a session.
+ * bench:  replays a session through the display functions and the ring log, every read of the session is issued
+ *         again through the stack; prints the time per pass in text, CSV and NDJSON and the speed against the
+ *         recorded time.
+ *
+ * Build: g++ -std=gnu++2a -O2 -Ihost -o session_tool host/session_tool.cpp host/Arduino.cpp $(find lib -name '*.cpp')
+ * Run:   ./session_tool record session.bin [seconds] [bq20|bq40]
+ *        ./session_tool import serial.txt session.bin
+ *        ./session_tool dump session.bin
+ *        ./session_tool bench session.bin [iterations] > /dev/null
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <Arduino.h>
+#include "../lib/SMB/SimTransport.h"
+#include "../lib/FiniteStateMachine/fsm.h"
+#include "../lib/display/commandtable.h"
+#include "../lib/logger/session.h"
+#include "../lib/logger/ringlog.h"
+
+static const char* kinds[5] {"probe", "read", "write", "block", "blockw"};
+
+static void run(Command& command, const char* line) {
+  CmdBuffer<64> buffer;
+  buffer.readFromString(line);
+  command.handleInput(buffer);
+  command.update();
+}
+
+// the commands of the recording: scan, the categories, a few registers and the background jobs
+static int record(const char* path, uint32_t seconds, bool bq40) {
+  simbattery battery(bq40 ? simbattery::BQ40Z6XX : simbattery::BQ20Z9XX);
+  filestore store(path);
+  sessionrecorder recorder(&battery, &store);
+  smbus::setDefaultTransport(&recorder); // the recorder of the command wraps this one and stays idle
+  Command recorded;
+  recorded.update();
+  if (!recorder.start()) {
+    fprintf(stderr, "%s can not be written\n", path);
+    return 1;
+  }
+  const char* lines[] {"2 11 11", "3 1", "3 2", "3 3", "3 4", "3 5", "4 voltage", "4 batteryStatus", "11 s 250", "13 start 500"};
+  for (const char* line : lines) run(recorded, line);
+  uint32_t start = millis();
+  while (millis() - start < seconds * 1000) {
+    recorded.update();
+    delay(1);
+  }
+  recorder.stop();
+  fprintf(stderr, "%u transactions, %u bytes, %.2f bytes per transaction\n", recorder.records(), recorder.bytes(),
+          recorder.records() ? (float)(recorder.bytes() - SESSIONHEADER) / recorder.records() : 0);
+  return 0;
+}
+
+static int import(const char* text, const char* path) {
+  FILE* in = fopen(text, "r");
+  if (in == nullptr) {
+    fprintf(stderr, "%s can not be read\n", text);
+    return 1;
+  }
+  filestore store(path);
+  if (!store.open()) return 1;
+  store.erase();
+  char line[256];
+  uint32_t bytes = 0;
+  while (fgets(line, sizeof(line), in)) {
+    char* hex = strstr(line, "x,"); // the line may follow an echo or a prompt
+    if (hex == nullptr) continue;
+    char* end;
+    uint32_t offset = strtoul(hex + 2, &end, 10);
+    if (*end != ',') continue;
+    uint8_t data[64];
+    uint16_t length = 0;
+    for (char* p = end + 1; isxdigit(p[0]) && isxdigit(p[1]) && length < sizeof(data); p += 2) {
+      char pair[3] {p[0], p[1], 0};
+      data[length++] = strtoul(pair, nullptr, 16);
+    }
+    if (store.write(offset, data, length)) bytes += length;
+  }
+  fclose(in);
+  fprintf(stderr, "%u bytes written to %s\n", bytes, path);
+  return 0;
+}
+
+static bool load(replaytransport& replay, const char* path) {
+  filestore store(path);
+  if (replay.load(store)) return true;
+  fprintf(stderr, "%s is not a session file\n", path);
+  return false;
+}
+
+static int dump(const char* path) {
+  replaytransport replay;
+  if (!load(replay, path)) return 1;
+  for (uint32_t i = 0; i < replay.size(); i++) {
+    const sessionrecord& record = replay.record(i);
+    printf("%10u %-6s 0x%02x", record.time, kinds[record.kind], record.address);
+    if (record.kind != SESSIONPROBE) printf(" 0x%02x", record.reg);
+    if (record.kind == SESSIONREADWORD || record.kind == SESSIONWRITEWORD) printf(" 0x%04x", record.word);
+    if (record.kind == SESSIONREADBLOCK || record.kind == SESSIONWRITEBLOCK) {
+      printf(" %2u:", record.length);
+      for (uint8_t n = 0; n < record.length; n++) printf(" %02x", record.block[n]);
+    }
+    if (record.code) printf(" i2c %u", record.code);
+    printf("\n");
+  }
+  fprintf(stderr, "%u transactions in %.3f s%s\n", replay.size(), replay.duration() / 1e6, replay.recordedPec() ? ", PEC" : "");
+  return 0;
+}
+
+// issues every read of the session again, through the display function of its register when there is one
+static void render(replaytransport& replay, Display* display, const uint8_t* commands) {
+  replay.rewind();
+  while (replay.position() < replay.size()) {
+    uint32_t position = replay.position();
+    const sessionrecord& record = replay.record(position);
+    uint8_t index = record.kind == SESSIONREADWORD && record.address == display->address() ? commands[record.reg] : NOCOMMAND;
+    if (index != NOCOMMAND) display->displayByIndex(index);
+    if (replay.position() > position) continue;
+    // no display function, or it was answered from the register cache
+    uint16_t word;
+    uint8_t block[SESSIONBLOCKMAX];
+    uint8_t length = sizeof(block);
+    if (record.kind == SESSIONPROBE) replay.probe(record.address);
+    else if (record.kind == SESSIONREADWORD) replay.readWord(record.address, record.reg, word);
+    else if (record.kind == SESSIONWRITEWORD) replay.writeWord(record.address, record.reg, record.word);
+    else if (record.kind == SESSIONREADBLOCK) replay.readBlock(record.address, record.reg, block, length);
+    else replay.writeBlock(record.address, record.reg, record.block, record.length);
+  }
+}
+
+// the voltage, current, temperature and charge reads of the session as log samples
+static uint32_t logged(replaytransport& replay, ringlog& log) {
+  logsample sample;
+  uint32_t samples = 0;
+  for (uint32_t i = 0; i < replay.size(); i++) {
+    const sessionrecord& record = replay.record(i);
+    if (record.kind != SESSIONREADWORD || record.code) continue;
+    if (record.reg == VOLTAGE) sample.voltage = record.word;
+    else if (record.reg == CURRENT) sample.current = record.word;
+    else if (record.reg == TEMPERATURE) sample.temperature = record.word;
+    else if (record.reg == RELATIVESTATEOFCHARGE) {
+      sample.charge = record.word;
+      sample.time = record.time / 1000;
+      log.append(record.address, sample);
+      samples++;
+    }
+  }
+  log.flush();
+  return samples;
+}
+
+static int bench(const char* path, uint32_t iterations) {
+  replaytransport replay;
+  if (!load(replay, path)) return 1;
+  smbus::setDefaultTransport(&replay);
+  uint8_t address = SIMADDRESS;
+  for (uint32_t i = 0; i < replay.size(); i++) {
+    if (replay.record(i).kind == SESSIONREADWORD) {
+      address = replay.record(i).address;
+      break;
+    }
+  }
+  batterysession session;
+  Display* display = session.open(address, &replay);
+  uint8_t commands[256];
+  memset(commands, NOCOMMAND, sizeof(commands));
+  for (uint8_t i = 0; i < COMMANDS; i++) {
+    if (commandRegister(i) != NOREGISTER) commands[commandRegister(i)] = i;
+  }
+
+  double recorded = replay.duration() / 1e6;
+  fprintf(stderr, "%u transactions, %.3f s recorded\n", replay.size(), recorded);
+  fprintf(stderr, "%-10s %12s %12s %12s %10s %10s\n", "pass", "ms/pass", "us/record", "x real time", "skipped", "misses");
+  const uint8_t formats[] {OUTPUTTEXT, OUTPUTCSV, OUTPUTJSON};
+  for (uint8_t format : formats) {
+    Display::setOutput(format);
+    uint32_t skipped = replay.skipped(), misses = replay.misses();
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < iterations; i++) render(replay, display, commands);
+    ansi.flush();
+    double elapsed = (micros() - start) / 1e6 / iterations;
+    fprintf(stderr, "%-10s %12.3f %12.3f %12.0f %10u %10u\n", outputName(format), elapsed * 1e3, elapsed * 1e6 / replay.size(),
+            recorded / elapsed, (replay.skipped() - skipped) / iterations, (replay.misses() - misses) / iterations);
+  }
+
+  filestore logfile("session_bench_log.bin");
+  ringlog log(&logfile);
+  log.begin();
+  log.erase();
+  uint32_t samples = 0;
+  uint32_t start = micros();
+  for (uint32_t i = 0; i < iterations; i++) samples = logged(replay, log);
+  double elapsed = (micros() - start) / 1e6 / iterations;
+  fprintf(stderr, "%-10s %12.3f %12.3f %12.0f  (%u samples)\n", "log", elapsed * 1e3, elapsed * 1e6 / replay.size(), recorded / elapsed,
+          samples);
+  remove("session_bench_log.bin");
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 3 && strcmp(argv[1], "record") == 0) {
+    return record(argv[2], argc > 3 ? strtoul(argv[3], nullptr, 0) : 10, argc > 4 && strcmp(argv[4], "bq40") == 0);
+  }
+  if (argc >= 4 && strcmp(argv[1], "import") == 0) return import(argv[2], argv[3]);
+  if (argc >= 3 && strcmp(argv[1], "dump") == 0) return dump(argv[2]);
+  if (argc >= 3 && strcmp(argv[1], "bench") == 0) return bench(argv[2], argc > 3 ? strtoul(argv[3], nullptr, 0) : 10);
+  fprintf(stderr, "use: session_tool record|import|dump|bench, see host/session_tool.cpp\n");
+  return 1;
+}
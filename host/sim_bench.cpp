@@ -0,0 +1,110 @@
+/**
+ * @file sim_bench.cpp
+ * @author
+ * @brief Host benchmark of the whole stack, from Command down to the transport, against the simulated battery.
+ * Every menu command is fed to Command::handleInput() like main.cpp does, the terminal output goes to stdout and the
+ * timing report to stderr. Then smbuscommands::readSnapshot(), all word registers in one frame, and the round-robin
+ * poller with 1 to 8 packs on one simulated bus.
+ *
+ * Build: g++ -std=gnu++2a -O2 -Ihost -o sim_bench host/sim_bench.cpp host/Arduino.cpp $(find lib -name '*.cpp')
+ * Run:   ./sim_bench [latency in us] [iterations] [bq20|bq40] > /dev/null
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <Arduino.h>
+#include "../lib/SMB/SimTransport.h"
+#include "../lib/FiniteStateMachine/fsm.h"
+#include "../lib/SMB/SMBCommands.h"
+#include "../lib/SMB/SMBPoller.h"
+
+static const char* commands[] {
+  "3 1",
+  "3 2",
+  "3 3",
+  "3 4",
+  "3 5",
+  "4 voltage",
+  "4 batteryStatus",
+};
+
+static void run(Command& command, const char* line) {
+  CmdBuffer<64> buffer;
+  buffer.readFromString(line);
+  command.handleInput(buffer);
+  command.update();
+}
+
+int main(int argc, char** argv) {
+  uint32_t latency = argc > 1 ? strtoul(argv[1], nullptr, 0) : 0;
+  uint32_t iterations = argc > 2 ? strtoul(argv[2], nullptr, 0) : 1;
+  bool bq40 = argc > 3 && strcmp(argv[3], "bq40") == 0;
+
+  simbattery battery(bq40 ? simbattery::BQ40Z6XX : simbattery::BQ20Z9XX);
+  battery.setLatency(latency);
+  smbus::setDefaultTransport(&battery);
+
+  Command command;
+  command.update();
+  run(command, "2 11 11");
+
+  // writes are the calls to the serial stream, unbuffered every byte is one
+  fprintf(stderr, "%-18s %12s %12s %14s %12s %12s\n", "command", "us/run", "transactions", "bus us/run", "bytes/run", "writes/run");
+  for (bool buffered : {true, false}) {
+    ansi.setBuffered(buffered);
+    if (!buffered) fprintf(stderr, "unbuffered:\n");
+    for (const char* line : commands) {
+      uint32_t transactions = battery.transactions();
+      uint64_t bus = battery.simulatedMicros();
+      uint32_t bytes = ansi.bytesWritten();
+      uint32_t writes = ansi.flushCount();
+      uint32_t start = micros();
+      for (uint32_t i = 0; i < iterations; i++) run(command, line);
+      uint32_t elapsed = micros() - start;
+      fprintf(stderr, "%-18s %12u %12u %14llu %12u %12u\n", line, elapsed / iterations, (battery.transactions() - transactions) / iterations,
+              (unsigned long long)(battery.simulatedMicros() - bus) / iterations, (ansi.bytesWritten() - bytes) / iterations,
+              (ansi.flushCount() - writes) / iterations);
+    }
+  }
+  ansi.setBuffered(true);
+
+  smbuscommands reader(SIMADDRESS, &battery);
+  smbsnapshot frame;
+  uint8_t good = 0;
+  uint32_t transactions = battery.transactions();
+  uint64_t bus = battery.simulatedMicros();
+  uint32_t start = micros();
+  for (uint32_t i = 0; i < iterations; i++) good = reader.readSnapshot(frame);
+  uint32_t elapsed = micros() - start;
+  fprintf(stderr, "%-18s %12u %12u %14llu  (%u of %u registers)\n", "snapshot", elapsed / iterations,
+          (battery.transactions() - transactions) / iterations,
+          (unsigned long long)(battery.simulatedMicros() - bus) / iterations, good, frame.count);
+
+  // one register per loop() pass: the bus time of a pass stays one transaction, the samples per pack drop with the pack count
+  fprintf(stderr, "\n%-18s %12s %12s %14s %14s\n", "packs", "samples/s", "per pack/s", "bus us/pass", "dump us/pass");
+  for (uint8_t packs = 1; packs <= 8; packs *= 2) {
+    simbus shared;
+    simbattery* batteries[8];
+    smbpoller poller;
+    for (uint8_t i = 0; i < packs; i++) {
+      batteries[i] = new simbattery(bq40 ? simbattery::BQ40Z6XX : simbattery::BQ20Z9XX, SIMADDRESS + i);
+      batteries[i]->setLatency(latency);
+      shared.attach(batteries[i]);
+      poller.add(SIMADDRESS + i, &shared);
+    }
+    uint32_t passes = 600 * iterations;
+    uint64_t before = shared.simulatedMicros();
+    for (uint32_t i = 0; i < passes; i++) poller.poll();
+    uint64_t used = shared.simulatedMicros() - before;
+    // the same samples as whole-pack dumps, every pass reads all registers of all packs
+    uint64_t dump = (uint64_t)used * POLLERREGISTERS * packs / passes;
+    fprintf(stderr, "%-18u %12.0f %12.0f %14llu %14llu\n", packs, poller.samples() * 1e6 / used,
+            poller.samples() * 1e6 / used / packs, (unsigned long long)(used / passes), (unsigned long long)dump);
+    for (uint8_t i = 0; i < packs; i++) delete batteries[i];
+  }
+  fflush(stdout);
+  return 0;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file telemetry_decode.cpp
+ * @author
+ * @brief Host decoder of the binary telemetry ('10 bin'). Reads the serial stream from stdin and prints one line per
+ * frame, text and echo between the frames are skipped. With --bench it compares the size of a snapshot as CSV, NDJSON
+ * and binary frame, and decodes a stream with corrupted bytes to show the CRC and the resync.
+ *
+ * Build: g++ -std=gnu++2a -O2 -Ihost -o telemetry_decode host/telemetry_decode.cpp host/Arduino.cpp $(find lib -name '*.cpp')
+ * Run:   ./telemetry_decode < capture.bin
+ *        ./telemetry_decode --bench [snapshots] [corrupt rate in permille]
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <Arduino.h>
+#include "../lib/telemetry/telemetry.h"
+#include "../lib/display/records.h"
+#include "../lib/SMB/SimTransport.h"
+
+#define BAUDBYTES 11520 /**< Bytes per second at 115200 baud, 8N1 */
+
+// counts the bytes a record would take on the serial line
+class counter : public Print {
+  public:
+  size_t write(uint8_t) override { bytes++; return 1; };
+  uint32_t bytes {0};
+};
+
+static void print(const telemetryrecord& record) {
+  printf("%s seq %u t %u addr 0x%02x us %u", record.type == TELEMETRYSNAPSHOT ? "snapshot" : "registers", record.sequence,
+         record.timestamp, record.address, record.duration);
+  for (uint8_t i = 0; i < record.count; i++) {
+    if (record.code[i]) printf(" %02x:!%u", record.reg[i], record.code[i]);
+    else if (sbsDescriptor(record.reg[i]).issigned) printf(" %02x:%d", record.reg[i], (int16_t)record.word[i]);
+    else printf(" %02x:%u", record.reg[i], record.word[i]);
+  }
+  printf("\n");
+}
+
+static int bench(uint32_t snapshots, uint16_t corrupt) {
+  simbattery battery;
+  smbuscommands reader(SIMADDRESS, &battery);
+  telemetryencoder encoder;
+  telemetrydecoder decoder;
+  counter csv, json;
+  uint32_t binary = 0, samples = 0, decoded = 0, damaged = 0, seed = 0x2545f491;
+  for (uint32_t i = 0; i < snapshots; i++) {
+    smbsnapshot frame;
+    samples += reader.readSnapshot(frame);
+    recordSnapshot(csv, OUTPUTCSV, frame);
+    recordSnapshot(json, OUTPUTJSON, frame);
+    uint8_t data[TELEMETRYFRAME];
+    uint16_t length = encoder.encode(frame, data);
+    binary += length;
+    for (uint16_t n = 0; n < length; n++) {
+      seed = seed * 1103515245 + 12345;
+      if (((seed >> 16) % 1000) < corrupt) {
+        data[n] ^= 1 << (seed % 8);  // may also hit a delimiter, the decoder has to resync
+        damaged++;
+      }
+      if (decoder.feed(data[n])) decoded++;
+    }
+  }
+  fprintf(stderr, "%-8s %14s %14s %16s\n", "format", "bytes/sample", "samples/s", "vs csv");
+  fprintf(stderr, "%-8s %14.2f %14.0f %16.2f\n", "csv", (double)csv.bytes / samples, (double)BAUDBYTES * samples / csv.bytes, 1.0);
+  fprintf(stderr, "%-8s %14.2f %14.0f %16.2f\n", "json", (double)json.bytes / samples, (double)BAUDBYTES * samples / json.bytes,
+          (double)csv.bytes / json.bytes);
+  fprintf(stderr, "%-8s %14.2f %14.0f %16.2f\n", "bin", (double)binary / samples, (double)BAUDBYTES * samples / binary,
+          (double)csv.bytes / binary);
+  fprintf(stderr, "\n%u frames, %u bytes corrupted: %u decoded, %u CRC errors, %u lost by sequence number\n", snapshots, damaged,
+          decoded, decoder.crcErrors(), decoder.lost());
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+    return bench(argc > 2 ? strtoul(argv[2], nullptr, 0) : 1000, argc > 3 ? strtoul(argv[3], nullptr, 0) : 0);
+  }
+  telemetrydecoder decoder;
+  int c;
+  while ((c = getchar()) != EOF) {
+    if (decoder.feed(c)) print(decoder.record());
+  }
+  fprintf(stderr, "%u frames, %u CRC errors, %u lost, %u bytes of text skipped\n", decoder.frames(), decoder.crcErrors(),
+          decoder.lost(), decoder.skipped());
+  return 0;
+}
@@ -0,0 +1,265 @@
+/**
+ * @file BQ20Flash.cpp
+ * @author
+ * @brief Function definitions for the data flash dump and restore of the bq20z9xx.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <Arduino.h>
+#include "BQ20Flash.h"
+#include "BQCommon.h"
+
+static const uint8_t flashmagic[4] {'B', 'Q', 'D', 'F'};
+
+// the image next to the ring log
+static logstore* flashStore() {
+#if defined(ARDUINO)
+  static littlefsstore store(FLASHFILE);
+  return &store;
+#elif defined(__linux__)
+  static filestore store(FLASHFILE + 1);
+  return &store;
+#else
+  return nullptr;
+#endif
+}
+
+static void flashDone(const smbrequest& request, void* context) {
+  ((bq20flash*)context)->completed(request);
+}
+
+/**
+ * @brief Constructor, nothing is transferred until dump() or restore().
+ * @param queue the transactions are submitted to this queue, it has to be polled
+ * @param store image file, nullptr for FLASHFILE
+ */
+bq20flash::bq20flash(smbqueue& queue, logstore* store) : queue(queue) {
+  this->store = store ? store : flashStore();
+}
+
+/**
+ * @brief Erases the image and starts reading every subclass into it.
+ * @param address of the battery
+ * @return bool false when busy or the file can not be written
+ */
+bool bq20flash::dump(uint8_t address) {
+  if (status == DUMPING || status == RESTORING || store == nullptr || !store->open()) return false;
+  store->erase();
+  uint8_t header[FLASHHEADER] {0};
+  memcpy(header, flashmagic, sizeof(flashmagic));
+  header[4] = FLASHVERSION;
+  header[5] = BQTYPE20Z9XX;
+  if (!store->write(0, header, FLASHHEADER)) return false; // 0 rows until the dump is complete
+  this->address = address;
+  offset = FLASHHEADER;
+  id = 0;
+  rowmask = (1 << FLASHPAGES) - 1;
+  phase = READ;
+  count = groups = comparedrows = writtenrows = failedrows = 0;
+  submitted = false;
+  started = finished = millis();
+  status = DUMPING;
+  return true;
+}
+
+/**
+ * @brief Starts writing the image back, only rows which differ from the battery are written.
+ * @param address of the battery
+ * @return bool false when busy or there is no valid image
+ */
+bool bq20flash::restore(uint8_t address) {
+  if (status == DUMPING || status == RESTORING || !image(total) || total == 0) return false;
+  this->address = address;
+  offset = FLASHHEADER;
+  count = groups = comparedrows = writtenrows = failedrows = 0;
+  submitted = false;
+  started = finished = millis();
+  status = RESTORING;
+  return nextGroup();
+}
+
+/**
+ * @brief Writes a piece of an image, f.e. received over serial.
+ * @param offset in the file, 0 erases the file first
+ * @param data
+ * @param length
+ * @return bool false when busy or the file can not be written
+ */
+bool bq20flash::upload(uint32_t offset, const uint8_t* data, uint16_t length) {
+  if (status == DUMPING || status == RESTORING || store == nullptr || !store->open()) return false;
+  if (offset == 0) {
+    store->erase();
+    status = IDLE;
+  }
+  return store->write(offset, data, length);
+}
+
+/**
+ * @brief Checks the header of the image file.
+ * @param rows set to the number of rows in the image
+ * @return bool false when the file is no complete image of a bq20z9xx
+ */
+bool bq20flash::image(uint16_t& rows) {
+  uint8_t header[FLASHHEADER];
+  rows = 0;
+  if (store == nullptr || !store->open() || store->size() < FLASHHEADER || !store->read(0, header, FLASHHEADER)) return false;
+  if (memcmp(header, flashmagic, sizeof(flashmagic)) != 0 || header[4] != FLASHVERSION || header[5] != BQTYPE20Z9XX) return false;
+  rows = header[6] | header[7] << 8;
+  return store->size() >= FLASHHEADER + (uint32_t)rows * FLASHRECORD;
+}
+
+/**
+ * @brief Submits the next batch or evaluates the finished one, call it from loop() next to the queue.
+ */
+void bq20flash::poll() {
+  if (status != DUMPING && status != RESTORING) return;
+  if (!submitted) {
+    submit();
+    return;
+  }
+  if (waiting) return;
+  submitted = false;
+  if (!incomplete) finish(); // else the whole batch is submitted again
+}
+
+/**
+ * @brief Submits the batch again, call it after the queue was cleared.
+ */
+void bq20flash::resubmit() {
+  submitted = false;
+  waiting = 0;
+}
+
+/**
+ * @brief Stores the result of a transaction of the batch.
+ * @param request
+ */
+void bq20flash::completed(const smbrequest& request) {
+  if (request.reg == DATAFLASHCLASS) selectcode = request.code;
+  else if (request.reg >= DATAFLASHPAGE && request.reg < DATAFLASHPAGE + FLASHPAGES) {
+    uint8_t page = request.reg - DATAFLASHPAGE;
+    rowcode[page] = request.code;
+    if (request.type == smbrequest::READBLOCK) rowlength[page] = request.code ? 0 : request.length;
+  }
+  if (waiting) waiting--;
+}
+
+// the select and the rows of rowmask, pipelined behind each other in the queue
+void bq20flash::submit() {
+  uint8_t needed = 1;
+  for (uint8_t page = 0; page < FLASHPAGES; page++) needed += rowmask >> page & 1;
+  if (SMBQUEUESIZE - queue.pending() < needed) return;
+  waiting = 0;
+  incomplete = false;
+  if (queue.submitWrite(address, DATAFLASHCLASS, id, flashDone, this) < 0) return; // rows without the select would go to another subclass
+  submitted = true;
+  waiting++;
+  for (uint8_t page = 0; page < FLASHPAGES; page++) {
+    if (!(rowmask >> page & 1)) continue;
+    int8_t handle = phase == WRITE ? queue.submitBlockWrite(address, DATAFLASHPAGE + page, imagedata[page], imagelength[page], flashDone, this)
+                                   : queue.submitBlock(address, DATAFLASHPAGE + page, rowdata[page], FLASHROWSIZE, flashDone, this);
+    if (handle < 0) {
+      incomplete = true;
+      return;
+    }
+    waiting++;
+  }
+}
+
+void bq20flash::finish() {
+  if (status == DUMPING) finishDump();
+  else finishRestore();
+}
+
+// rows up to the first one which fails or is short go to the image
+void bq20flash::finishDump() {
+  uint8_t buffer[FLASHPAGES * FLASHRECORD];
+  uint16_t used = 0;
+  uint8_t found = 0;
+  for (uint8_t page = 0; selectcode == SMB_OK && page < FLASHPAGES; page++) {
+    if (rowcode[page] != SMB_OK || rowlength[page] == 0) break;
+    uint8_t* record = buffer + used;
+    record[0] = id;
+    record[1] = page;
+    record[2] = rowlength[page];
+    memcpy(record + 3, rowdata[page], rowlength[page]);
+    memset(record + 3 + rowlength[page], 0, FLASHROWSIZE - rowlength[page]);
+    used += FLASHRECORD;
+    found++;
+    if (rowlength[page] < FLASHROWSIZE) break;
+  }
+  if (found) {
+    if (!store->write(offset, buffer, used)) {
+      end(FAILED);
+      return;
+    }
+    offset += used;
+    count += found;
+    groups++;
+  }
+  if (++id < FLASHSUBCLASSES) return;
+  uint8_t rows[2] {(uint8_t)(count & 0xff), (uint8_t)(count >> 8)};
+  end(store->write(6, rows, 2) ? DONE : FAILED);
+}
+
+// read, write the rows which differ, read them back
+void bq20flash::finishRestore() {
+  uint8_t next = 0;
+  for (uint8_t page = 0; page < FLASHPAGES; page++) {
+    if (!(rowmask >> page & 1)) continue;
+    bool ok = selectcode == SMB_OK && rowcode[page] == SMB_OK;
+    bool same = ok && rowlength[page] == imagelength[page] && memcmp(rowdata[page], imagedata[page], imagelength[page]) == 0;
+    if (phase == READ) {
+      comparedrows++;
+      // a row which can not be read or has another size is not written
+      if (!ok || rowlength[page] != imagelength[page]) failedrows++;
+      else if (!same) next |= 1 << page;
+    } else if (phase == WRITE) {
+      if (ok) {
+        writtenrows++;
+        next |= 1 << page;
+      } else failedrows++;
+    } else if (!same) failedrows++;
+  }
+  if (next && phase != VERIFY) {
+    rowmask = next;
+    phase++;
+    return;
+  }
+  nextGroup();
+}
+
+// loads the rows of the next subclass of the image
+bool bq20flash::nextGroup() {
+  rowmask = 0;
+  phase = READ;
+  while (count < total) {
+    uint8_t record[FLASHRECORD];
+    if (!store->read(offset, record, FLASHRECORD) || record[1] >= FLASHPAGES || record[2] > FLASHROWSIZE) {
+      end(FAILED);
+      return false;
+    }
+    if (rowmask && record[0] != id) break;
+    id = record[0];
+    imagelength[record[1]] = record[2];
+    memcpy(imagedata[record[1]], record + 3, FLASHROWSIZE);
+    rowmask |= 1 << record[1];
+    offset += FLASHRECORD;
+    count++;
+  }
+  if (rowmask == 0) {
+    end(DONE);
+    return false;
+  }
+  groups++;
+  return true;
+}
+
+void bq20flash::end(uint8_t result) {
+  status = result;
+  finished = millis();
+}
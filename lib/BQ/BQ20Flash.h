@@ -0,0 +1,100 @@
+/**
+ * @file BQ20Flash.h
+ * @author
+ * @brief Dump and restore of the whole data flash of a bq20z9xx. The data flash is reached through the SubClass block
+ * commands: DataFlashClass (0x77) selects a subclass, DataFlashClassSubClass1-8 (0x78 - 0x7f) read and write its rows
+ * of 32 bytes. The battery has to be unsealed (5) or in full access (8).
+ * A dump selects every subclass id in turn and reads all 8 rows behind the select in one batch through the queue, the
+ * rows which answer go to the image file. A restore reads the rows of a subclass, writes only the rows which differ
+ * from the image and reads them back to verify.
+ * The image starts with a header (magic "BQDF", version, chip type, number of rows, little endian) followed by the
+ * rows: subclass id, row 0 - 7, number of bytes, 32 bytes padded with 0.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include "../SMB/SMBQueue.h"
+#include "../logger/logstore.h"
+
+#define FLASHFILE       "/dataflash.bin" /**< Name of the image on LittleFS */
+#define FLASHHEADER     8
+#define FLASHVERSION    1
+#define FLASHROWSIZE    32
+#define FLASHPAGES      8                 /**< Rows per subclass, one register each */
+#define FLASHRECORD     (3 + FLASHROWSIZE)
+#define FLASHSUBCLASSES 128               /**< Subclass ids tried by a dump */
+#define DATAFLASHCLASS  0x77
+#define DATAFLASHPAGE   0x78              /**< DataFlashClassSubClass1, row n is 0x78 + n */
+
+class bq20flash {
+  public:
+  enum {
+    IDLE = 0,
+    DUMPING,
+    RESTORING,
+    DONE,
+    FAILED,     /**< The image can not be read or written */
+  };
+  bq20flash(smbqueue& queue, logstore* store = nullptr);
+  bool dump(uint8_t address);
+  bool restore(uint8_t address);
+  bool upload(uint32_t offset, const uint8_t* data, uint16_t length);
+  bool image(uint16_t& rows);
+  void poll();
+  void resubmit();
+  void completed(const smbrequest& request);
+
+  uint8_t state() { return status; };
+  uint8_t subclass() { return id; };
+  uint16_t rows() { return count; };
+  uint16_t subclasses() { return groups; };
+  uint16_t compared() { return comparedrows; };
+  uint16_t written() { return writtenrows; };
+  uint16_t failures() { return failedrows; };
+  uint32_t elapsed() { return finished - started; };
+  logstore* file() { return store; };
+
+  private:
+  enum {
+    READ = 0,   /**< Rows of the subclass are read */
+    WRITE,      /**< Rows which differ from the image are written */
+    VERIFY,     /**< Written rows are read back */
+  };
+  void submit();
+  void finish();
+  void finishDump();
+  void finishRestore();
+  bool nextGroup();
+  void end(uint8_t result);
+
+  smbqueue& queue;
+  logstore* store;
+  uint8_t address {0};
+  uint8_t status {IDLE};
+  uint8_t phase {READ};
+  uint8_t id {0};                               // subclass of the batch
+  uint8_t rowmask {0};                          // rows of the batch, bit n is row n
+  uint8_t rowdata[FLASHPAGES][FLASHROWSIZE];    // rows read
+  uint8_t rowlength[FLASHPAGES];
+  uint8_t rowcode[FLASHPAGES];
+  uint8_t imagedata[FLASHPAGES][FLASHROWSIZE];  // rows of the image, restore only
+  uint8_t imagelength[FLASHPAGES];
+  uint8_t selectcode {0};                       // i2c code of the DataFlashClass write
+  uint8_t waiting {0};                          // requests of the batch not done yet
+  bool submitted {false};
+  bool incomplete {false};                      // a request of the batch did not fit in the queue
+  uint32_t offset {0};                          // dump: end of the image, restore: next row of the image
+  uint16_t total {0};                           // rows in the image
+  uint16_t count {0};
+  uint16_t groups {0};
+  uint16_t comparedrows {0};
+  uint16_t writtenrows {0};
+  uint16_t failedrows {0};
+  uint32_t started {0};
+  uint32_t finished {0};
+};
@@ -1,6 +1,6 @@
 #include "BQ20Z9xx.h"
 
-bq20z9xx::bq20z9xx(uint8_t address) : smbuscommands(address) {
+bq20z9xx::bq20z9xx(uint8_t address, smbtransport* transport) : smbuscommands(address, transport) {
 }
 
 /**
@@ -178,6 +178,7 @@ uint16_t bq20z9xx::stateOfHealth() {
  */
 uint16_t bq20z9xx::safetyAlert() {
   safetyalert.raw = readRegister(SAFETYALERT);
+  if (!i2ccode) flagchanges[SAFETYALERT - SAFETYALERT].update(safetyalert.raw);
   return safetyalert.raw;
 }
 
@@ -189,6 +190,7 @@ uint16_t bq20z9xx::safetyAlert() {
  */
 uint16_t bq20z9xx::safetyStatus() {
   safetystatus.raw = readRegister(SAFETYSTATUS);
+  if (!i2ccode) flagchanges[SAFETYSTATUS - SAFETYALERT].update(safetystatus.raw);
   return safetystatus.raw;
 }
 
@@ -201,6 +203,7 @@ uint16_t bq20z9xx::safetyStatus() {
  */
 uint16_t bq20z9xx::pfAlert() {
   pfalert.raw = readRegister(PFALERT);
+  if (!i2ccode) flagchanges[PFALERT - SAFETYALERT].update(pfalert.raw);
   return pfalert.raw;
 }
 
@@ -213,6 +216,7 @@ uint16_t bq20z9xx::pfAlert() {
  */
 uint16_t bq20z9xx::pfStatus() {
   pfstatus.raw = readRegister(PFSTATUS);
+  if (!i2ccode) flagchanges[PFSTATUS - SAFETYALERT].update(pfstatus.raw);
   return pfstatus.raw;
 }
 
@@ -225,9 +229,19 @@ uint16_t bq20z9xx::pfStatus() {
  */
 uint16_t bq20z9xx::operationStatus() {
   operationstatus.raw = readRegister(OPERATIONSTATUS);
+  if (!i2ccode) flagchanges[OPERATIONSTATUS - SAFETYALERT].update(operationstatus.raw);
   return operationstatus.raw;
 }
 
+/**
+ * @brief Bits of a flag register which flipped at its last read.
+ * @param reg SAFETYALERT .. OPERATIONSTATUS
+ * @return uint32_t
+ */
+uint32_t bq20z9xx::flagsChanged(uint8_t reg) {
+  return reg >= SAFETYALERT && reg <= OPERATIONSTATUS ? flagchanges[reg - SAFETYALERT].changed : 0;
+}
+
 /**
  * @brief Read Unseal Key.
  * The bq20z90/bq20z95 Unseal Key can be read when in full access mode 
@@ -1,40 +1,82 @@
 #include "BQ40Z6xx.h"
 
-bq40z6xx::bq40z6xx(uint8_t address) : smbuscommands(address) {
+bq40z6xx::bq40z6xx(uint8_t address, smbtransport* transport) : smbuscommands(address, transport) {
+}
+
+/**
+ * @brief Sends a sub-command and reads its response through ManufacturerBlockAccess. The sub-command is written as a
+ * 2 byte block, the response block starts with the sub-command it belongs to, which is checked.
+ * • SBS:ManufacturerBlockAccess(0x44)
+ * @param command sub-command
+ * @param data filled with the response without the echo
+ * @param length size of data
+ * @return uint8_t bytes of the response stored, i2ccode is SMB_ECHO when the response is for another sub-command
+ */
+uint8_t bq40z6xx::manufacturerBlockAccess(uint16_t command, uint8_t* data, uint8_t length) {
+  uint8_t request[2] {(uint8_t)(command & 0xff), (uint8_t)(command >> 8)};
+  smbus::writeBlock(ALTERNATEMANUFACTURERACCESS, request, sizeof(request), batteryAddress);
+  if (i2ccode) return 0;
+  uint8_t buffer[32];
+  uint8_t count = sizeof(buffer);
+  i2ccode = bus->readBlock(batteryAddress, ALTERNATEMANUFACTURERACCESS, buffer, count);
+  countError(ALTERNATEMANUFACTURERACCESS, i2ccode);
+  if (i2ccode) return 0;
+  if (count < 2 || buffer[0] != request[0] || buffer[1] != request[1]) {
+    i2ccode = SMB_ECHO;
+    return 0;
+  }
+  count = count - 2 < length ? count - 2 : length;
+  memcpy(data, buffer + 2, count);
+  return count;
+}
+
+/**
+ * @brief Reads the response of a sub-command into the manufacturerdata union. ManufacturerBlockAccess is used, it does
+ * not disturb the register cache as a write to ManufacturerAccess does; a battery which does not acknowledge it is
+ * asked through ManufacturerAccess (0x00) and ManufacturerData (0x23).
+ * @param command sub-command
+ * @return char* manufacturerdata.raw, i2ccode is SMB_NACKDATA when there is no response
+ */
+char* bq40z6xx::manufacturerAccessRead(uint16_t command) {
+  memset(manufacturerdata.raw, 0, sizeof(manufacturerdata.raw));
+  uint8_t count = manufacturerBlockAccess(command, reinterpret_cast<uint8_t*>(manufacturerdata.raw), sizeof(manufacturerdata.raw) - 1);
+  if (i2ccode == SMB_NACKADDR || i2ccode == SMB_NACKDATA) {
+    writeRegister(MANUFACTURERACCESS, command);
+    return manufacturerData();
+  }
+  if (!i2ccode && count == 0) i2ccode = SMB_NACKDATA;
+  return manufacturerdata.raw;
 }
 
 /**
  * @brief implementation specific.
  * Content determined by the Smart Battery's manufacturer.
- * • SBS:ManufacturerAccess(0x00)
+ * • SBS:ManufacturerBlockAccess(0x44)
  * @return char*
  */
 char* bq40z6xx::manufacturerAccessType() {
-  writeRegister(MANUFACTURERACCESS, MANUFACTURERACCESSTYPE);
-  return manufacturerData();
+  return manufacturerAccessRead(MANUFACTURERACCESSTYPE);
 }
 
 /**
  * @brief implementation specific.
  * Content determined by the Smart Battery's manufacturer. The format is most-significant byte (MSB) = Decimal integer, and the
  * least-significant byte (LSB) = sub-decimal integer, e.g.: 0x0120 = version 01.20.
- * • SBS:ManufacturerAccess(0x00)
+ * • SBS:ManufacturerBlockAccess(0x44)
  * @return char*
  */
 char* bq40z6xx::manufacturerAccessFirmware() {
-  writeRegister(MANUFACTURERACCESS, MANUFACTURERACCESSFIRMWARE);
-  return manufacturerData();
+  return manufacturerAccessRead(MANUFACTURERACCESSFIRMWARE);
 }
 
 /**
  * @brief implementation specific.
  * Content determined by the Smart Battery's manufacturer. Returns the hardware version stored in a single byte of reserved data flash.
- * • SBS:ManufacturerAccess(0x00)
+ * • SBS:ManufacturerBlockAccess(0x44)
  * @return char*
  */
 char* bq40z6xx::manufacturerAccessHardware() {
-  writeRegister(MANUFACTURERACCESS, MANUFACTURERACCESSHARDWARE);
-  return manufacturerData();
+  return manufacturerAccessRead(MANUFACTURERACCESSHARDWARE);
 }
 
 /**
@@ -42,8 +84,7 @@ char* bq40z6xx::manufacturerAccessHardware() {
  * @return uint16_t
  */
 char* bq40z6xx::manufacturerAccessChemistryID() {
-  writeRegister(MANUFACTURERACCESS, MANUFACTURERACCESSCHEMISTRY);
-  return manufacturerData();
+  return manufacturerAccessRead(MANUFACTURERACCESSCHEMISTRY);
 }
 
 /**
@@ -81,8 +122,7 @@ void bq40z6xx::manufacturerAccessSeal() {
 }
 
 char* bq40z6xx::manufacturerSecurityKeys() {
-  writeRegister(MANUFACTURERACCESS, MANUFACTURERACCESSSECURITYKEYS);
-  return manufacturerData();
+  return manufacturerAccessRead(MANUFACTURERACCESSSECURITYKEYS);
 }
 
 /**
@@ -96,6 +136,30 @@ char* bq40z6xx::manufacturerData() {
   return manufacturerdata.raw;
 }
 
+/**
+ * @brief Reads a flag register, a 4 byte block least significant byte first, into the raw field of its union and
+ * records the bits which flipped since the read before. The union keeps its value when the read fails.
+ * @param reg SAFETYALERT .. OPERATIONSTATUS
+ * @param flags union of the register
+ */
+template <typename U>
+void bq40z6xx::readFlags(uint8_t reg, U& flags) {
+  uint8_t data[sizeof(flags.raw)] {0};
+  readBlock(reg, data, sizeof(data));
+  if (i2ccode) return;
+  flags.raw = flagsFromBlock<decltype(flags.raw)>(data);
+  flagchanges[reg - SAFETYALERT].update(flags.raw);
+}
+
+/**
+ * @brief Bits of a flag register which flipped at its last read.
+ * @param reg SAFETYALERT .. OPERATIONSTATUS
+ * @return uint32_t
+ */
+uint32_t bq40z6xx::flagsChanged(uint8_t reg) {
+  return reg >= SAFETYALERT && reg <= OPERATIONSTATUS ? flagchanges[reg - SAFETYALERT].changed : 0;
+}
+
 /**
  * @brief Returns indications of pending safety issues.
  * This function fills a safetyalert union indicating pending safety issues, such as running safety timers, or fail 
@@ -104,15 +168,7 @@ char* bq40z6xx::manufacturerData() {
  * @return fills safetyalert union
  */
 void bq40z6xx::safetyAlert() {
-  readRegister(SAFETYALERT);
-  char* data = manufacturerData();
-  safetyalert.raw &= data[0];
-  safetyalert.raw <<= 8;
-  safetyalert.raw &= data[1];
-  safetyalert.raw <<= 8;
-  safetyalert.raw &= data[2];
-  safetyalert.raw <<= 8;
-  safetyalert.raw &= data[3];
+  readFlags(SAFETYALERT, safetyalert);
 }
 
 /**
@@ -122,15 +178,7 @@ void bq40z6xx::safetyAlert() {
  * @return uint16_t
  */
 void bq40z6xx::safetyStatus() {
-  readRegister(SAFETYSTATUS);
-  char* data = manufacturerData();
-  safetystatus.raw &= data[0];
-  safetystatus.raw <<= 8;
-  safetystatus.raw &= data[1];
-  safetystatus.raw <<= 8;
-  safetystatus.raw &= data[2];
-  safetystatus.raw <<= 8;
-  safetystatus.raw &= data[3];
+  readFlags(SAFETYSTATUS, safetystatus);
 }
 
 /**
@@ -141,15 +189,7 @@ void bq40z6xx::safetyStatus() {
  * @return uint16_t 
  */
 void bq40z6xx::pfAlert() {
-  readRegister(PFALERT);
-  char* data = manufacturerData();
-  pfalert.raw &= data[0];
-  pfalert.raw <<= 8;
-  pfalert.raw &= data[1];
-  pfalert.raw <<= 8;
-  pfalert.raw &= data[2];
-  pfalert.raw <<= 8;
-  pfalert.raw &= data[3];
+  readFlags(PFALERT, pfalert);
 }
 
 
@@ -161,15 +201,7 @@ void bq40z6xx::pfAlert() {
  * @return uint16_t
  */
 void bq40z6xx::pfStatus() {
-  readRegister(PFSTATUS);
-  char* data = manufacturerData();
-  pfstatus.raw &= data[0];
-  pfstatus.raw <<= 8;
-  pfstatus.raw &= data[1];
-  pfstatus.raw <<= 8;
-  pfstatus.raw &= data[2];
-  pfstatus.raw <<= 8;
-  pfstatus.raw &= data[3];
+  readFlags(PFSTATUS, pfstatus);
 }
 
 /**
@@ -180,15 +212,7 @@ void bq40z6xx::pfStatus() {
  * @return uint16_t 
  */
 void bq40z6xx::operationStatus() {
-  readRegister(OPERATIONSTATUS);
-  char* data = manufacturerData();
-  operationstatus.raw &= data[0];
-  operationstatus.raw <<= 8;
-  operationstatus.raw &= data[1];
-  operationstatus.raw <<= 8;
-  operationstatus.raw &= data[2];
-  operationstatus.raw <<= 8;
-  operationstatus.raw &= data[3];
+  readFlags(OPERATIONSTATUS, operationstatus);
 }
 
 /**
@@ -231,3 +255,28 @@ void bq40z6xx::manufacturerAccessFullAccess(uint16_t Key_a, uint16_t Key_b) {
   writeRegister(MANUFACTURERACCESS, Key_b);
 }
 
+
+/**
+ * @brief Get the current FET status from the battery.
+ * The bq40z6xx has no FETControl register, the FETs are toggled with ManufacturerAccess 0x0022. The state of the FETs
+ * is taken from OperationStatus and put in a fetcontrol union, so it can be shown the same way as for the bq20z9xx.
+ * • SBS:OperationStatus(0x54)
+ * @return uint16_t
+ */
+uint16_t bq40z6xx::fetControl() {
+  operationStatus();
+  fetcontrol.raw = 0;
+  fetcontrol.bits.dsg = operationstatus.bits.dsg;
+  fetcontrol.bits.chg = operationstatus.bits.chg;
+  return fetcontrol.raw;
+}
+
+/**
+ * @brief Get the State of Health from the battery.
+ * Returns the estimated health of the battery, as a percentage of design capacity.
+ * • SBS:StateOfHealth(0x4f)
+ * @return uint16_t
+ */
+uint16_t bq40z6xx::stateOfHealth() {
+  return readRegister(STATEOFHEALTH);
+}
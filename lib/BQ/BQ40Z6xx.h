@@ -13,41 +13,13 @@
 #include <Arduino.h>
 #include <string.h>
 #include "../SMB/SMBCommands.h"
-
-#define BQICTYPE bq40z6xx
-
-#define UNSEALA                         0x0414 /**< Unseal Key a */
-#define UNSEALB                         0x3672 /**< Unseal Key b */
-#define FULLACCESSA                     0xffff
-#define FULLACCESSB                     0xffff
-#define PFCLEARA                        0x2673 /**< Permanent Failure Clear Key A or 0x0001 , 0x0102*/
-#define PFCLEARB                        0x1712 /**< Permanent Failure Clear Key B */
-
-// following commands are part of the SBS manufactureraccess command 0x00 (so to used as f.e 0x00 0x0001)
-#define MANUFACTURERACCESSTYPE          0x0001
-#define MANUFACTURERACCESSFIRMWARE      0x0002
-#define MANUFACTURERACCESSHARDWARE      0x0003
-//#define MANUFACTURERACCESSTATUS       0x0006
-#define MANUFACTURERACCESSCHEMISTRY     0x0006
-#define MANUFACTURERACCESSSHUTDOWN      0x0010
-#define MANUFACTURERACCESSSLEEP         0x0011
-#define MANUFACTURERACCESSFETCONTROL    0x0022
-#define MANUFACTURERACCESSSEAL          0x0030
-#define MANUFACTURERACCESSSECURITYKEYS  0x0035
-#define MANUFACTURERACCESSCHARGINGSTATUS 0x0055
-
-#define MANUFACTURERACCESSSTATEOFHEALTH 0x0077
+#include "../SMB/SMBFlags.h"
+#include "BQCommon.h"
 
 // following commands are direct SBS commands
 #define ALTERNATEMANUFACTURERACCESS     0x44
-#define SAFETYALERT                     0x50
-#define SAFETYSTATUS                    0x51
-#define PFALERT                         0x52
-#define PFSTATUS                        0x53
-#define OPERATIONSTATUS                 0x54
 #define CHARGINGSTATUS                  0x54
 #define MANUFACTURINGSTATUS             0x57
-//#define UNSEALKEY                     0x60
 #define MANUFACTURERINFO                0x70
 
 /**
@@ -56,11 +28,27 @@
  */
 class bq40z6xx : protected smbuscommands{
   protected:
-  bq40z6xx(uint8_t address);
-  char* manufacturerAccessType();      // command 0x00 0x0001 read data via 0x23 (manufacturerData)
-  char* manufacturerAccessFirmware();     // command 0x00 0x0002 read data via 0x23 (manufacturerData)
-  char* manufacturerAccessHardware();     // command 0x00 0x0003 read data via 0x23 (manufacturerData)
-  char* manufacturerAccessChemistryID();  // command 0x00 0x0006 read data via 0x23 (manufacturerData)
+  // ManufacturerAccess sub-commands, the result is read via ManufacturerBlockAccess (0x44) or ManufacturerData (0x23)
+  enum : uint16_t {
+    MANUFACTURERACCESSTYPE           = 0x0001,
+    MANUFACTURERACCESSFIRMWARE       = 0x0002,
+    MANUFACTURERACCESSHARDWARE       = 0x0003,
+    MANUFACTURERACCESSCHEMISTRY      = 0x0006,
+    MANUFACTURERACCESSSHUTDOWN       = 0x0010,
+    MANUFACTURERACCESSSLEEP          = 0x0011,
+    MANUFACTURERACCESSFETCONTROL     = 0x0022,
+    MANUFACTURERACCESSSEAL           = 0x0030,
+    MANUFACTURERACCESSSECURITYKEYS   = 0x0035,
+    MANUFACTURERACCESSCHARGINGSTATUS = 0x0055,
+    MANUFACTURERACCESSSTATEOFHEALTH  = 0x0077,
+  };
+  bq40z6xx(uint8_t address, smbtransport* transport = nullptr);
+  uint8_t manufacturerBlockAccess(uint16_t command, uint8_t* data, uint8_t length); // command 0x44
+  char* manufacturerAccessRead(uint16_t command);
+  char* manufacturerAccessType();      // command 0x44 0x0001
+  char* manufacturerAccessFirmware();     // command 0x44 0x0002
+  char* manufacturerAccessHardware();     // command 0x44 0x0003
+  char* manufacturerAccessChemistryID();  // command 0x44 0x0006
   void manufacturerAccessShutdown();      // command 0x0010
   void manufacturerAccessSleep();         // command 0x0011
 
@@ -312,55 +300,10 @@ class bq40z6xx : protected smbuscommands{
   }operationstatus;
 
 uint32_t unsealKey();           // command 0x60
+  uint32_t flagsChanged(uint8_t reg);
 //  private:
+  template <typename U>
+  void readFlags(uint8_t reg, U& flags);
+  flagdelta<uint32_t> flagchanges[OPERATIONSTATUS - SAFETYALERT + 1]; // 0x50 - 0x54
 };
 
-uint16_t manufacturerStatus(); // command 0x57
-
-/**
- * @section statuscodes
- * @brief Holds the description of the various state_codes (see ManufacturerStatus).
- *
- */
-static String statuscodes[16] {
-  "Wake up",                /**> If the 4 bits contain a 0 */
-  "Normal Discharge",       /**> If the 4 bits contain a 1 */
-  "Not defined",            /**> Code 2 is not defined */
-  "Pre-Charge",             /**> If the 4 bits contain a 3 */
-  "Not defined",            /**> Code 4 is not defined */
-  "Charge",                 /**> If the 4 bits contain a 5 */
-  "Not defined",            /**> Code 6 is not defined */
-  "Charge Termination",     /**> If the 4 bits contain a 7 */
-  "Fault Charge Terminate", /**> If the 4 bits contain a 8 */
-  "Permanent Failure",      /**> If the 4 bits contain a 9 */
-  "Overcurrent",            /**> If the 4 bits contain a 10 */
-  "Overtemperature",        /**> If the 4 bits contain a 11 */
-  "Battery Failure",        /**> If the 4 bits contain a 12 */
-  "Sleep",                  /**> If the 4 bits contain a 13 */
-  "Reserved",               /**> Code 14 is reserved */
-  "Battery Removed",        /**> If the 4 bits contain a 15 */
-};
-
-/**
- * @section fetcodes
- * @brief Holds the description of the states of the FETs (see Manufacturer Status(0x0006)).
- *
- */
-static String fetcodes[4] {
-  "Both charge and discharge FETs are on",  /**> If the 2 bits contain a 0 */
-  "CHG FET is off, DSG FET is on",          /**> If the 2 bits contain a 1 */
-  "Both charge and discharge FETs are off", /**> If the 2 bits contain a 2 */
-  "CHG FET is on, DSG FET is off"           /**> If the 2 bits contain a 3 */
-};
-
-/**
- * @section permanentfailurecodes
- * @brief Indicates permanent failure cause when permanent failure indicated by STATE3..STATE0 (see Manufacturer Status(0x0006)).
- *
- */
-static String permanentfailurecodes[4] {
-  "Fuse is blown if enabled via DF:Configuration:Register(64):Permanent Fail Cfg(6)",  /**> If the 2 bits contain a 0 */
-  "Cell imbalance failure",                 /**> If the 2 bits contain a 1 */
-  "Safety voltage failure",                 /**> If the 2 bits contain a 2 */
-  "FET failure"                             /**> If the 2 bits contain a 3 */
-};
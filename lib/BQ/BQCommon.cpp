@@ -0,0 +1,72 @@
+/**
+ * @file BQCommon.cpp
+ * @author
+ * @brief The texts of the ManufacturerStatus fields, stored once in flash.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "BQCommon.h"
+
+/**
+ * @section statuscodes
+ * @brief Holds the description of the various state_codes (see ManufacturerStatus).
+ *
+ */
+static const char statuscodes[16][23] PROGMEM {
+  "Wake up",                /**> If the 4 bits contain a 0 */
+  "Normal Discharge",       /**> If the 4 bits contain a 1 */
+  "Not defined",            /**> Code 2 is not defined */
+  "Pre-Charge",             /**> If the 4 bits contain a 3 */
+  "Not defined",            /**> Code 4 is not defined */
+  "Charge",                 /**> If the 4 bits contain a 5 */
+  "Not defined",            /**> Code 6 is not defined */
+  "Charge Termination",     /**> If the 4 bits contain a 7 */
+  "Fault Charge Terminate", /**> If the 4 bits contain a 8 */
+  "Permanent Failure",      /**> If the 4 bits contain a 9 */
+  "Overcurrent",            /**> If the 4 bits contain a 10 */
+  "Overtemperature",        /**> If the 4 bits contain a 11 */
+  "Battery Failure",        /**> If the 4 bits contain a 12 */
+  "Sleep",                  /**> If the 4 bits contain a 13 */
+  "Reserved",               /**> Code 14 is reserved */
+  "Battery Removed",        /**> If the 4 bits contain a 15 */
+};
+
+/**
+ * @section fetcodes
+ * @brief Holds the description of the states of the FETs (see Manufacturer Status(0x0006)).
+ *
+ */
+static const char fetcodes[4][39] PROGMEM {
+  "Both charge and discharge FETs are on",  /**> If the 2 bits contain a 0 */
+  "CHG FET is off, DSG FET is on",          /**> If the 2 bits contain a 1 */
+  "Both charge and discharge FETs are off", /**> If the 2 bits contain a 2 */
+  "CHG FET is on, DSG FET is off"           /**> If the 2 bits contain a 3 */
+};
+
+/**
+ * @section permanentfailurecodes
+ * @brief Indicates permanent failure cause when permanent failure indicated by STATE3..STATE0 (see Manufacturer Status(0x0006)).
+ *
+ */
+static const char permanentfailurecodes[4][81] PROGMEM {
+  "Fuse is blown if enabled via DF:Configuration:Register(64):Permanent Fail Cfg(6)",  /**> If the 2 bits contain a 0 */
+  "Cell imbalance failure",                 /**> If the 2 bits contain a 1 */
+  "Safety voltage failure",                 /**> If the 2 bits contain a 2 */
+  "FET failure"                             /**> If the 2 bits contain a 3 */
+};
+
+const __FlashStringHelper* statusCode(uint8_t state) {
+  return FPSTR(statuscodes[state & 0x0f]);
+}
+
+const __FlashStringHelper* fetCode(uint8_t fet) {
+  return FPSTR(fetcodes[fet & 0x03]);
+}
+
+const __FlashStringHelper* permanentFailureCode(uint8_t pf) {
+  return FPSTR(permanentfailurecodes[pf & 0x03]);
+}
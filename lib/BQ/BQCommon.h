@@ -0,0 +1,41 @@
+/**
+ * @file BQCommon.h
+ * @author
+ * @brief Definitions shared by the bq20z9xx and bq40z6xx: default keys, extended SBS registers, the chip types and the
+ * texts of the manufacturer status. The ManufacturerAccess sub-commands differ per chip and are defined in the classes.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#define UNSEALA                     0x0414 /**< Unseal Key a */
+#define UNSEALB                     0x3672 /**< Unseal Key b */
+#define FULLACCESSA                 0xffff
+#define FULLACCESSB                 0xffff
+#define PFCLEARA                    0x2673 /**< Permanent Failure Clear Key A or 0x0001 , 0x0102*/
+#define PFCLEARB                    0x1712 /**< Permanent Failure Clear Key B */
+
+// extended SBS commands, available in unsealed mode
+#define FETCONTROL                  0x46
+#define STATEOFHEALTH               0x4f
+#define SAFETYALERT                 0x50
+#define SAFETYSTATUS                0x51
+#define PFALERT                     0x52
+#define PFSTATUS                    0x53
+#define OPERATIONSTATUS             0x54
+#define UNSEALKEY                   0x60
+
+// chip types, see bqDetect()
+#define BQTYPEUNKNOWN               0
+#define BQTYPE20Z9XX                1
+#define BQTYPE40Z6XX                2
+
+// texts of the ManufacturerStatus fields, the tables are in flash (BQCommon.cpp)
+const __FlashStringHelper* statusCode(uint8_t state);
+const __FlashStringHelper* fetCode(uint8_t fet);
+const __FlashStringHelper* permanentFailureCode(uint8_t pf);
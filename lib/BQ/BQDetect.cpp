@@ -0,0 +1,89 @@
+/**
+ * @file BQDetect.cpp
+ * @author
+ * @brief Function definitions for the runtime chip detection.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "BQDetect.h"
+#include <string.h>
+#include "../SMB/SMBCommands.h"
+
+struct bqdetected {
+  smbtransport* transport;
+  uint8_t address;
+  uint8_t chip;
+};
+
+static bqdetected detected[BQDETECTCACHE] {};
+static uint8_t nextslot {0};
+
+/**
+ * @brief Asks the battery which chip it is.
+ * 1. ManufacturerAccess 0x0001 (device type): the bq20z9xx answers in ManufacturerAccess with 0x09xx, the bq40z6xx
+ *    keeps the command in ManufacturerAccess and answers in ManufacturerData with 0x4xxx.
+ * 2. When that gives no answer (f.e. another gauge) DeviceName is used, it starts with "bq20" or "bq40".
+ * @param address
+ * @param bus
+ * @return uint8_t BQTYPE20Z9XX, BQTYPE40Z6XX or BQTYPEUNKNOWN
+ */
+static uint8_t probeChip(uint8_t address, smbtransport* bus) {
+  uint16_t type = 0;
+  if (bus->writeWord(address, MANUFACTURERACCESS, 0x0001) == SMB_OK && bus->readWord(address, MANUFACTURERACCESS, type) == SMB_OK) {
+    if ((type & 0xff00) == 0x0900) return BQTYPE20Z9XX;
+    uint8_t data[BLOCKLENGTH];
+    uint8_t length = sizeof(data);
+    if (type == 0x0001 && bus->readBlock(address, MANUFACTURERDATA, data, length) == SMB_OK && length >= 2) {
+      uint16_t device = data[0] | data[1] << 8;
+      if ((device & 0xf000) == 0x4000) return BQTYPE40Z6XX;
+    }
+  }
+  char name[BLOCKLENGTH + 1] {0};
+  uint8_t length = BLOCKLENGTH;
+  if (bus->readBlock(address, DEVICENAME, reinterpret_cast<uint8_t*>(name), length) == SMB_OK) {
+    if (strncasecmp(name, "bq20", 4) == 0) return BQTYPE20Z9XX;
+    if (strncasecmp(name, "bq40", 4) == 0) return BQTYPE40Z6XX;
+  }
+  return BQTYPEUNKNOWN;
+}
+
+/**
+ * @brief Returns the chip on an address, probing it only the first time.
+ * @param address
+ * @param transport, nullptr for the default transport
+ * @return uint8_t BQTYPE20Z9XX, BQTYPE40Z6XX or BQTYPEUNKNOWN
+ */
+uint8_t bqDetect(uint8_t address, smbtransport* transport) {
+  smbtransport* bus = transport ? transport : smbus::defaultTransport();
+  for (const bqdetected& entry : detected) {
+    if (entry.transport == bus && entry.address == address) return entry.chip;
+  }
+  uint8_t chip = probeChip(address, bus);
+  detected[nextslot] = {bus, address, chip};
+  nextslot = (nextslot + 1) % BQDETECTCACHE;
+  return chip;
+}
+
+/**
+ * @brief Forgets the detected chip, f.e. when the battery was replaced.
+ * @param address
+ * @param transport, nullptr for the default transport
+ */
+void bqForget(uint8_t address, smbtransport* transport) {
+  smbtransport* bus = transport ? transport : smbus::defaultTransport();
+  for (bqdetected& entry : detected) {
+    if (entry.transport == bus && entry.address == address) entry = {nullptr, 0, BQTYPEUNKNOWN};
+  }
+}
+
+const char* bqChipName(uint8_t chip) {
+  switch (chip) {
+    case BQTYPE20Z9XX: return "bq20z9xx";
+    case BQTYPE40Z6XX: return "bq40z6xx";
+    default: return "unknown";
+  }
+}
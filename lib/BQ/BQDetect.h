@@ -0,0 +1,22 @@
+/**
+ * @file BQDetect.h
+ * @author
+ * @brief Detects at runtime which bq chip answers on an address, so one firmware can handle a mixed set of batteries.
+ * The result is remembered per transport and address, probing the same battery again costs no bus traffic.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include "../SMB/SMBTransport.h"
+#include "BQCommon.h"
+
+#define BQDETECTCACHE 8 /**< Number of detection results remembered */
+
+uint8_t bqDetect(uint8_t address, smbtransport* transport = nullptr);
+void bqForget(uint8_t address, smbtransport* transport = nullptr);
+const char* bqChipName(uint8_t chip);
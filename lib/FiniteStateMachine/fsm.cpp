@@ -2,51 +2,143 @@
 #include "../i2cscanner/i2cscanner.h"
 #include "../display/display.h"
 #include "../display/menus.h"
+#include "../BQ/BQDetect.h"
 
 CmdParser cmd;
 ANSI ansi(&Serial);
 
+// id of the job of a type, -1 when there is none
+static int8_t findJob(Command& command, uint8_t type) {
+    for (uint8_t id = 0; id < SCHEDULERJOBS; id++) {
+        if (command.jobs.job(id).type == type) return id;
+    }
+    return -1;
+}
+
 // class Command
-Command::Command() {
+// every transaction of the stack passes the recorder, the queue is built on it, the others take the default transport
+Command::Command() : queue(&recorder) {
+}
+
+Command::~Command() {
+    if (installed && smbus::defaultTransport() == &recorder) smbus::setDefaultTransport(recorder.targetTransport());
+}
+
+// the recorder wraps the default transport and takes its place, at the first update() or input and not in the
+// constructor: the global command is built before setup() and the Wire transport starts the bus
+void Command::install() {
+    if (installed) return;
+    installed = true;
+    recorder.targetTransport();
+    smbus::setDefaultTransport(&recorder);
 }
 
-void Command::handleInput (CmdBuffer<64> buffer) {
+void Command::handleInput (CmdBufferObject& buffer) {
+    install();
     if (cmd.parseCmd(&buffer) == CMDPARSER_ERROR) return;
     String com = cmd.getCommand();
     uint8_t i = com.toInt();
     CommandState* state = state_->handleInput(*this, i);
     if (state != nullptr) {
-        delete state_;
+        queue.clear(); // pending requests may belong to the old state
+        logwaiting = 0; // a sample whose reads were dropped is not logged
+        flash.resubmit(); // a dump or restore goes on with the batch which was dropped
+        poller.clear();
         state_ = state;
         state_->enter(*this);
     }
 }
 
 void Command::update () {
+    install();
+    flash.poll();
+    if (!queue.poll()) {
+        if (capture && capture->state() == smbcapture::TRIGGERED) capturing(); // full rate until the capture is frozen
+        else {
+            int8_t job = jobs.poll(millis());
+            if (job >= 0) run(jobs.job(job));
+            else poller.poll();
+        }
+    }
     if(state_) state_->update();
     else {
-        state_ = new menuState;
+        state_ = &states.menu;
         state_->enter(*this);
     }
+    ansi.flush(); // a line without newline (prompt, table) is not kept in the buffer
+}
+
+static void logRead(const smbrequest& request, void* context) {
+    static_cast<Command*>(context)->logged(request);
+}
+
+// runs a scheduled job on the selected battery, a job without battery is skipped but counted
+void Command::run(const schedulejob& job) {
+    if (display == nullptr) return;
+    if (job.type == schedulejob::CATEGORY) display->displayByClassifier(job.arg);
+    else if (job.type == schedulejob::NAME) display->displayByIndex(job.arg);
+    else if (job.type == schedulejob::SNAPSHOT) display->displaySnapshot();
+    else if (job.type == schedulejob::HISTORY && history) history->sample(millis());
+    else if (job.type == schedulejob::CAPTURE && capture) capturing();
+    else if (job.type == schedulejob::LOG && logwaiting == 0) {
+        // the four registers are read through the queue, one per pass, logged() appends the sample
+        const uint8_t registers[] {VOLTAGE, CURRENT, TEMPERATURE, RELATIVESTATEOFCHARGE};
+        sample = logsample();
+        sample.time = millis();
+        for (uint8_t reg : registers) {
+            if (queue.submitRead(display->address(), reg, logRead, this) >= 0) logwaiting++;
+            else sample.valid = false;
+        }
+        if (logwaiting == 0) log.append(display->address(), sample);
+    }
+}
+
+// takes a capture sample, when it froze the capture the sampling job ends
+void Command::capturing() {
+    capture->sample(millis());
+    if (capture->state() != smbcapture::FROZEN) return;
+    int8_t job = findJob(*this, schedulejob::CAPTURE);
+    if (job >= 0) jobs.remove(job);
+    ansi.printf("Capture triggered by bits 0x%lx of register 0x%02x, use 14 d to download\n", (unsigned long)capture->triggerBits(),
+                capture->watchedRegister());
+}
+
+// collects the registers of a log sample, the last one appends it to the log
+void Command::logged(const smbrequest& request) {
+    if (logwaiting == 0) return;
+    if (request.code != 0) sample.valid = false;
+    else if (request.reg == VOLTAGE) sample.voltage = request.word;
+    else if (request.reg == CURRENT) sample.current = request.word;
+    else if (request.reg == TEMPERATURE) sample.temperature = request.word;
+    else if (request.reg == RELATIVESTATEOFCHARGE) sample.charge = request.word;
+    if (--logwaiting == 0) log.append(request.address, sample);
 }
 
 void CommandState::enter(Command& command) {
 }
 
 CommandState* CommandState::handleInput (Command& command, uint8_t input) {
-    if (input == 1) return new menuState;
-    if (input == 2) return new scanState;
+    if (input == 1) return &command.states.menu;
+    if (input == 2) return &command.states.scan;
+    if (input == 9) return &command.states.poll;
+    if (input == 10) return &command.states.output;
+    if (input == 11) return &command.states.schedule;
+    if (input == 12) return &command.states.log;
+    if (input == 13) return &command.states.history;
+    if (input == 14) return &command.states.capture;
+    if (input == 15) return &command.states.record;
+    if (input == 16) return &command.states.flash;
     if (command.display == nullptr) {
-        Serial.println("please select '2' (Search address) first");
+        ansi.println("please select '2' (Search address) first");
     } else {
-        if (input == 3) return new categoryState;
-        else if (input == 4) return new commandnameState;
-        else if (input == 5) return new unsealState;
-        else if (input == 6) return new sealState;
-        else if (input == 7) return new clearpfState;
-        else if (input == 8) return new fullaccessState;
+        if (input == 3) return &command.states.category;
+        else if (input == 4) return &command.states.commandname;
+        else if (input == 5) return &command.states.unseal;
+        else if (input == 6) return &command.states.seal;
+        else if (input == 7) return &command.states.clearpf;
+        else if (input == 8) return &command.states.fullaccess;
     }
-    return new menuState;
+    return &command.states.menu;
 }
 
 void CommandState::update () {
@@ -76,7 +168,8 @@ void scanState::enter(Command& command) {
         if (first <= second) address =i2cscan(first, second);
     } else address = i2cscan();
     if (address > 0) {
-        command.display = new Display(address);
+        bqForget(address); // the pack may have been swapped, every battery answers on 0x0b
+        command.display = command.session.open(address);
         command.display->displayBatteryAddress();
     }
 }
@@ -87,11 +180,11 @@ void scanState::enter(Command& command) {
 }*/
 
 void categoryState::enter(Command& command) {
-    displaySmallmenu();
+    if (Display::getOutput() == OUTPUTTEXT) displaySmallmenu(); // records are not mixed with escape sequences
     if(cmd.getParamCount() == 2) {
         String param = cmd.getCmdParam(1);
         command.display->displayByClassifier(param.toInt());
-    } else Serial.println("please specify category. Select '3 x' (x is category number)");
+    } else ansi.println("please specify category. Select '3 x' (x is category number)");
 }
 
 // class extended = 4
@@ -100,21 +193,33 @@ void categoryState::enter(Command& command) {
 }*/
 
 void commandnameState::enter(Command& command) {
-    displaySmallmenu();
+    if (Display::getOutput() == OUTPUTTEXT) displaySmallmenu(); // records are not mixed with escape sequences
     if(cmd.getParamCount() == 2) {
         String param = cmd.getCmdParam(1);
         (param == "?")? command.display->displayCommandNames():command.display->displayByName(param);
         
-    } else Serial.println("Please specify command name. Select '3 x' (x is name, or use ?)");
+    } else ansi.println("Please specify command name. Select '3 x' (x is name, or use ?)");
 }
 
 // class unseal = 5
 CommandState* unsealState::handleInput (Command& command, uint8_t input) {
-    return new menuState;
+    return &command.states.menu;
+}
+
+// stops the key search when the battery does not accept a key anymore
+static void keyWritten(const smbrequest& request, void* context) {
+    if (request.code == 0) return;
+    ansi.print("Key search stopped at 0x");
+    ansi.print(request.word, HEX);
+    ansi.print(": ");
+    ansi.println(i2cCode(request.code));
+    static_cast<unsealState*>(context)->stop();
 }
 
+// one key per pass of loop(), queued so the serial input is read between the transactions
 void unsealState::update () {
-    com->display->testkey(key);
+    if (!scanning || !com->queue.idle()) return;
+    com->queue.submitWrite(com->display->address(), MANUFACTURERACCESS, key, keyWritten, this);
     key++;
     if (key == 0xffff) scanning = false;
 }
@@ -122,6 +227,8 @@ void unsealState::update () {
 void unsealState::enter(Command& command) {
     displaySmallmenu();
     com = &command;
+    scanning = false;
+    key = 0x1000;
     if(cmd.getParamCount() == 2) {
         String param = cmd.getCmdParam(1);
         if (param == "?") scanning = true;
@@ -147,7 +254,7 @@ void sealState::enter(Command& command) {
 
 // class clear pf = 7
 CommandState* clearpfState::handleInput (Command& command, uint8_t input) {
-    return new menuState;
+    return &command.states.menu;
 }
 
 void clearpfState::enter(Command& command) {
@@ -167,7 +274,7 @@ void clearpfState::update () {
 
 // class full access = 8
 CommandState* fullaccessState::handleInput (Command& command, uint8_t input) {
-    return new menuState;
+    return &command.states.menu;
 }
 
 void fullaccessState::enter(Command& command) {
@@ -182,4 +289,499 @@ void fullaccessState::enter(Command& command) {
 
 void fullaccessState::update () {
 //    command.display->findkey();
-}
\ No newline at end of file
+}
+
+// class poll = 9
+void pollState::enter(Command& command) {
+    displaySmallmenu();
+    com = &command;
+    shown = false;
+    for (uint32_t& samples : last) samples = 0;
+    uint8_t found[POLLERBATTERIES];
+    uint8_t from = 0, to = 127, count;
+    if(cmd.getParamCount() == 3) {
+        from = (uint8_t)cmd.toLong(1);
+        to = (uint8_t)cmd.toLong(2);
+    }
+    count = i2cscanAll(from, to, found, POLLERBATTERIES);
+    for (uint8_t i = 0; i < count; i++) {
+        if (!command.poller.add(found[i])) continue;
+        // detected once here, the refresh only prints it and does not touch ManufacturerAccess
+        smbbattery& battery = command.poller.battery(command.poller.count() - 1);
+        battery.chip = bqDetect(battery.address, battery.bus);
+    }
+    ansi.print(count);
+    ansi.println(" batteries polled round-robin");
+    printed = millis();
+}
+
+void pollState::update() {
+    if (com->poller.count() == 0 || millis() - printed < POLLPRINTMS) return;
+    print();
+}
+
+// prints one line per battery, the table is overwritten in place on every refresh
+void pollState::print() {
+    uint32_t now = millis();
+    uint32_t elapsed = now - printed;
+    printed = now;
+    smbpoller& poller = com->poller;
+    if (shown) ansi.cursorUp(poller.count());
+    shown = true;
+    for (uint8_t i = 0; i < poller.count(); i++) {
+        smbbattery& battery = poller.battery(i);
+        ansi.print('\r');
+        ansi.clearLine();
+        ansi.printf("0x%02x %-9s %6.3fV %6dmA %3u%% %5.1fC %5u/s %u errors",
+                    battery.address, bqChipName(battery.chip),
+                    battery.word[poller.index(VOLTAGE)] / 1000.0, (int16_t)battery.word[poller.index(CURRENT)],
+                    battery.word[poller.index(RELATIVESTATEOFCHARGE)], battery.word[poller.index(TEMPERATURE)] / 10.0 - 273.15, (battery.samples - last[i]) * 1000 / (elapsed ? elapsed : 1),
+                    battery.errors);
+        ansi.println();
+        last[i] = battery.samples;
+    }
+}
+
+// class output = 10
+void outputState::enter(Command& command) {
+    com = &command;
+    remaining = 0;
+    if(cmd.getParamCount() < 2) {
+        ansi.print("Output is ");
+        ansi.println(outputName(Display::getOutput()));
+        return;
+    }
+    String param = cmd.getCmdParam(1);
+    if (param == "s") {
+        if (command.display == nullptr) ansi.println("please select '2' (Search address) first");
+        else remaining = cmd.getParamCount() == 3 ? cmd.toLong(2) : 1;
+        return;
+    }
+    for (uint8_t format = OUTPUTTEXT; format <= OUTPUTBINARY; format++) {
+        if (param == outputName(format)) {
+            Display::setOutput(format);
+            return;
+        }
+    }
+    ansi.println("Use 10 text, 10 csv, 10 json, 10 bin or 10 s [count]");
+}
+
+// one snapshot per pass of loop(), a new command stops the stream
+void outputState::update() {
+    if (remaining == 0) return;
+    com->display->displaySnapshot();
+    remaining--;
+}
+
+// class schedule = 11
+void scheduleState::enter(Command& command) {
+    uint16_t params = cmd.getParamCount();
+    if (params < 2) {
+        list(command);
+        return;
+    }
+    String param = cmd.getCmdParam(1);
+    if (param == "x") {
+        command.jobs.clear();
+        ansi.println("All jobs removed");
+        return;
+    }
+    if (param == "d" && params == 3) {
+        if (!command.jobs.remove(cmd.toLong(2))) ansi.println("No such job");
+        return;
+    }
+    int8_t id = -1;
+    if (param == "s" && params == 3) {
+        id = command.jobs.add(schedulejob::SNAPSHOT, 0, cmd.toLong(2), millis());
+    } else if (param == "c" && params == 4) {
+        uint8_t category = cmd.toLong(2);
+        if (category < DEVICEINFO || category > ATRATES) {
+            ansi.println("Category is 1 to 5");
+            return;
+        }
+        id = command.jobs.add(schedulejob::CATEGORY, category, cmd.toLong(3), millis());
+    } else if (param == "n" && params == 4) {
+        uint8_t index = commandFind(cmd.getCmdParam(2));
+        uint8_t first;
+        if (index == NOCOMMAND && commandPrefix(cmd.getCmdParam(2), first) == 1) index = commandSorted(first);
+        if (index == NOCOMMAND) {
+            ansi.print("Function \"");
+            ansi.print(cmd.getCmdParam(2));
+            ansi.println("\" not found or not unique.");
+            return;
+        }
+        id = command.jobs.add(schedulejob::NAME, index, cmd.toLong(3), millis());
+    } else {
+        ansi.println("Use 11 c category ms, 11 n name ms, 11 s ms, 11 d id, 11 x or 11 to list");
+        return;
+    }
+    if (id < 0) ansi.println("No free job");
+    else {
+        ansi.print("Job ");
+        ansi.print(id);
+        ansi.println(" added");
+    }
+}
+
+// one line per job with its statistics, jitter is how late the job ran in ms
+void scheduleState::list(Command& command) {
+    if (command.jobs.count() == 0) {
+        ansi.println("No jobs, use 11 c category ms, 11 n name ms or 11 s ms");
+        return;
+    }
+    ansi.println("id job                                   period ms     runs overruns jitter max/mean ms");
+    for (uint8_t id = 0; id < SCHEDULERJOBS; id++) {
+        const schedulejob& job = command.jobs.job(id);
+        if (job.type == schedulejob::FREE) continue;
+        ansi.printf("%2u ", id);
+        if (job.type == schedulejob::CATEGORY) ansi.printf("category %-28u", job.arg);
+        else if (job.type == schedulejob::NAME) {
+            char name[COMMANDNAMESIZE];
+            commandName(job.arg, name);
+            ansi.printf("%-37s", name);
+        } else if (job.type == schedulejob::LOG) ansi.printf("%-37s", "log");
+        else if (job.type == schedulejob::HISTORY) ansi.printf("%-37s", "history");
+        else if (job.type == schedulejob::CAPTURE) ansi.printf("%-37s", "capture");
+        else ansi.printf("%-37s", "snapshot");
+        ansi.printf(" %9lu %8lu %8lu %10lu/%lu\n", (unsigned long)job.period, (unsigned long)job.runs, (unsigned long)job.overruns,
+                    (unsigned long)job.jittermax, (unsigned long)(job.runs ? job.jittersum / job.runs : 0));
+    }
+}
+
+// class log = 12
+
+void logState::enter(Command& command) {
+    com = &command;
+    dumping = 0;
+    if (!command.log.isOpen() && !command.log.begin()) {
+        ansi.println("Log file can not be opened");
+        return;
+    }
+    String param = cmd.getParamCount() >= 2 ? cmd.getCmdParam(1) : "";
+    int8_t job = findJob(command, schedulejob::LOG);
+    if (param == "start" && cmd.getParamCount() == 3) {
+        if (command.display == nullptr) {
+            ansi.println("please select '2' (Search address) first");
+            return;
+        }
+        if (job >= 0) command.jobs.remove(job);
+        if (command.jobs.add(schedulejob::LOG, 0, cmd.toLong(2), millis()) < 0) ansi.println("No free job");
+        else ansi.println("Logging");
+    } else if (param == "stop") {
+        if (job >= 0) command.jobs.remove(job);
+        command.log.flush();
+        ansi.println("Logging stopped");
+    } else if (param == "d") {
+        command.log.flush();
+        page = 0;
+        dumping = command.log.pages();
+    } else if (param == "x") {
+        command.log.erase();
+        ansi.println("Log erased");
+    } else if (param == "") {
+        ansi.printf("%lu of %u pages, %lu samples since start, %lu page writes, ", (unsigned long)command.log.pages(), LOGPAGES,
+                    (unsigned long)command.log.records(), (unsigned long)command.log.writes());
+        if (job >= 0) ansi.printf("logging every %lu ms\n", (unsigned long)command.jobs.job(job).period);
+        else ansi.println("not logging");
+    } else ansi.println("Use 12 start ms, 12 stop, 12 d (dump), 12 x (erase) or 12 for the state");
+}
+
+// prints one page per pass of loop(), so the dump does not hold up the bus or the input
+void logState::update() {
+    if (dumping == 0) return;
+    uint8_t data[LOGPAGESIZE];
+    if (com->log.readPage(page, data)) {
+        logcursor cursor;
+        uint8_t address;
+        ringlog::beginPage(data, cursor, address);
+        while (ringlog::nextRecord(data, cursor)) recordLog(ansi, Display::getOutput(), address, cursor.value);
+    }
+    page++;
+    dumping--;
+}
+
+// class history = 13
+void historyState::enter(Command& command) {
+    uint16_t params = cmd.getParamCount();
+    String param = params >= 2 ? cmd.getCmdParam(1) : "";
+    int8_t job = findJob(command, schedulejob::HISTORY);
+    if (param == "start") {
+        if (command.display == nullptr) {
+            ansi.println("please select '2' (Search address) first");
+            return;
+        }
+        if (job >= 0) command.jobs.remove(job);
+        if (!command.history || command.history->address() != command.display->address()) command.history.emplace(command.display->address());
+        uint32_t period = params == 3 ? cmd.toLong(2) : 1000;
+        if (command.jobs.add(schedulejob::HISTORY, 0, period, millis()) < 0) ansi.println("No free job");
+        else ansi.println("Collecting history");
+    } else if (param == "stop") {
+        if (job >= 0) command.jobs.remove(job);
+        ansi.println("History stopped, the values are kept");
+    } else if (!command.history) {
+        ansi.println("No history, use 13 start [ms]");
+    } else if (param == "") {
+        table(command);
+    } else if (params == 3) {
+        uint8_t index = commandFind(param.c_str());
+        uint8_t first;
+        if (index == NOCOMMAND && commandPrefix(param.c_str(), first) == 1) index = commandSorted(first);
+        int8_t ring = index == NOCOMMAND ? -1 : command.history->index(commandRegister(index));
+        if (ring < 0) {
+            ansi.println("History is kept for voltage, current, temperature and relativeStateOfCharge");
+            return;
+        }
+        uint32_t window = cmd.toLong(2) * 1000;
+        rollup values = command.history->ring(ring).window(window, millis());
+        if (Display::getOutput() != OUTPUTTEXT) {
+            recordRollup(ansi, Display::getOutput(), command.history->address(), smbhistory::registers[ring], window, values);
+            return;
+        }
+        ansi.print(commandName(index));
+        ansi.printf(" over %lu s: %lu samples, min %d, avg %d, max %d\n", (unsigned long)(window / 1000), (unsigned long)values.count, values.min,
+                    values.average(), values.max);
+    } else ansi.println("Use 13 start [ms], 13 stop, 13 name seconds or 13 for the table");
+}
+
+// last value and avg (min..max) of the last minute, hour and since the start, in the unit of the register
+void historyState::table(Command& command) {
+    smbhistory& history = *command.history;
+    uint32_t now = millis();
+    const char* names[HISTORYREGISTERS] {"voltage mV", "current mA", "temp 0.1K", "charge %"};
+    ansi.println("register          last        1 min avg (min..max)      1 h avg (min..max)   start avg (min..max)");
+    for (uint8_t i = 0; i < HISTORYREGISTERS; i++) {
+        rollupring& ring = history.ring(i);
+        ansi.printf("%-12s %9d", names[i], ring.last());
+        const uint32_t windows[] {HISTORYMINUTEMS, 60 * HISTORYMINUTEMS, 0xffffffff};
+        for (uint32_t window : windows) {
+            rollup values = ring.window(window, now);
+            if (values.count) ansi.printf(" %7d (%6d..%6d)", values.average(), values.min, values.max);
+            else ansi.printf(" %23s", "-");
+        }
+        ansi.println();
+    }
+    ansi.printf("%lu read errors\n", (unsigned long)history.errors());
+}
+
+// class capture = 14
+
+/**
+ * @struct capturetrigger
+ * @brief A register the capture can watch, with the bits which trigger unless a mask is given.
+ */
+struct capturetrigger {
+    const char* name;
+    uint8_t reg;
+    uint32_t mask;
+};
+
+// the error code of BatteryStatus changes with every failed command, it does not trigger by default
+static const capturetrigger capturetriggers[] {
+    {"overtemp",        BATTERYSTATUS,   0x1000},
+    {"termdischarge",   BATTERYSTATUS,   0x0800},
+    {"batteryStatus",   BATTERYSTATUS,   0xfff0},
+    {"safetyAlert",     SAFETYALERT,     0xffffffff},
+    {"safetyStatus",    SAFETYSTATUS,    0xffffffff},
+    {"pfAlert",         PFALERT,         0xffffffff},
+    {"pfStatus",        PFSTATUS,        0xffffffff},
+    {"operationStatus", OPERATIONSTATUS, 0xffffffff},
+};
+
+void captureState::enter(Command& command) {
+    com = &command;
+    dumping = 0;
+    String param = cmd.getParamCount() >= 2 ? cmd.getCmdParam(1) : "";
+    int8_t job = findJob(command, schedulejob::CAPTURE);
+    if (param == "arm") arm(command);
+    else if (param == "x") {
+        if (job >= 0) command.jobs.remove(job);
+        if (command.capture) command.capture->disarm();
+        ansi.println("Capture disarmed");
+    } else if (!command.capture) {
+        ansi.println("No capture, use 14 arm name [ms] [mask]");
+    } else if (param == "d") {
+        next = 0;
+        dumping = command.capture->count();
+    } else if (param == "") show(command);
+    else ansi.println("Use 14 arm name [ms] [mask], 14 x (disarm), 14 d (download) or 14 for the state");
+}
+
+// 14 arm name [ms] [mask]: samples every ms (default 100) while armed
+void captureState::arm(Command& command) {
+    if (command.display == nullptr) {
+        ansi.println("please select '2' (Search address) first");
+        return;
+    }
+    uint16_t params = cmd.getParamCount();
+    const capturetrigger* trigger = nullptr;
+    if (params >= 3) {
+        for (const capturetrigger& entry : capturetriggers) {
+            if (strcasecmp(cmd.getCmdParam(2), entry.name) == 0) trigger = &entry;
+        }
+    }
+    if (trigger == nullptr) {
+        ansi.print("Use 14 arm name [ms] [mask] with name one of");
+        for (const capturetrigger& entry : capturetriggers) ansi.printf(" %s", entry.name);
+        ansi.println();
+        return;
+    }
+    uint32_t period = params >= 4 ? cmd.toLong(3) : 100;
+    uint32_t mask = params >= 5 ? cmd.toLong(4) : trigger->mask;
+    uint8_t address = command.display->address();
+    // the flag registers of the bq40z6xx are 4 byte blocks
+    bool wide = trigger->reg >= SAFETYALERT && trigger->reg <= OPERATIONSTATUS && bqDetect(address) == BQTYPE40Z6XX;
+    int8_t job = findJob(command, schedulejob::CAPTURE);
+    if (job >= 0) command.jobs.remove(job);
+    if (!command.capture || command.capture->address() != address) command.capture.emplace(address);
+    command.capture->arm(trigger->reg, mask, wide);
+    if (command.jobs.add(schedulejob::CAPTURE, 0, period, millis()) < 0) {
+        command.capture->disarm();
+        ansi.println("No free job");
+    } else ansi.printf("Armed on bits 0x%lx of register 0x%02x, sampling every %lu ms\n", (unsigned long)mask, trigger->reg, (unsigned long)period);
+}
+
+void captureState::show(Command& command) {
+    smbcapture& capture = *command.capture;
+    const char* states[] {"idle", "armed", "triggered", "frozen"};
+    ansi.printf("%s on bits 0x%lx of register 0x%02x, %u of %u samples, %lu read errors", states[capture.state()],
+                (unsigned long)capture.watchedMask(), capture.watchedRegister(), capture.count(), CAPTURESAMPLES,
+                (unsigned long)capture.errors());
+    if (capture.triggerIndex() >= 0) ansi.printf(", triggered by bits 0x%lx at sample %d", (unsigned long)capture.triggerBits(), capture.triggerIndex());
+    ansi.println();
+}
+
+// prints a few samples per pass of loop(), the time in the text table is relative to the trigger
+void captureState::update() {
+    for (uint8_t n = 0; n < 8 && dumping > 0; n++, next++, dumping--) {
+        smbcapture& capture = *com->capture;
+        const capturesample& value = capture.at(next);
+        int16_t trigger = capture.triggerIndex();
+        if (Display::getOutput() != OUTPUTTEXT) {
+            recordCapture(ansi, Display::getOutput(), capture.address(), capture.watchedRegister(), value, next == trigger);
+            continue;
+        }
+        if (next == 0) ansi.println("     ms       mV       mA   0.1K    watched");
+        int32_t ms = trigger >= 0 ? (int32_t)(value.time - capture.at(trigger).time) : (int32_t)(value.time - capture.at(0).time);
+        ansi.printf("%7ld %8u %8d %6u 0x%08lx%s\n", (long)ms, value.voltage, value.current, value.temperature,
+                    (unsigned long)value.watched, next == trigger ? " <" : "");
+    }
+}
+
+// class record = 15
+void recordState::enter(Command& command) {
+    com = &command;
+    offset = end = 0;
+    sessionrecorder& recorder = command.recorder;
+    String param = cmd.getParamCount() >= 2 ? cmd.getCmdParam(1) : "";
+    if (param == "start") {
+        if (recorder.start()) ansi.println("Recording every bus transaction");
+        else ansi.println("Session file can not be opened");
+    } else if (param == "stop") {
+        recorder.stop();
+        ansi.printf("Recorded %lu transactions, %lu bytes\n", (unsigned long)recorder.records(), (unsigned long)recorder.bytes());
+    } else if (param == "d") {
+        recorder.stop();
+        logstore* file = recorder.file();
+        end = file && file->open() ? file->size() : 0;
+    } else if (param == "") {
+        ansi.printf("%s, %lu transactions, %lu of %lu bytes\n", recorder.isRecording() ? "recording" : recorder.isFull() ? "full" : "not recording",
+                    (unsigned long)recorder.records(), (unsigned long)recorder.bytes(), (unsigned long)SESSIONMAXBYTES);
+    } else ansi.println("Use 15 start, 15 stop, 15 d (download as hex) or 15 for the state");
+}
+
+// prints a file as x,<offset>,<hex> lines, a few per pass of loop(); host/session_tool import turns them back into a file
+static void printHex(logstore* file, uint32_t& offset, uint32_t& end) {
+    for (uint8_t n = 0; n < 8 && offset < end; n++) {
+        uint8_t data[32];
+        uint16_t length = end - offset < sizeof(data) ? end - offset : sizeof(data);
+        if (!file->read(offset, data, length)) {
+            end = 0;
+            return;
+        }
+        ansi.printf("x,%lu,", (unsigned long)offset);
+        for (uint16_t i = 0; i < length; i++) ansi.printf("%02x", data[i]);
+        ansi.println();
+        offset += length;
+    }
+}
+
+void recordState::update() {
+    if (offset < end) printHex(com->recorder.file(), offset, end);
+}
+
+// class flash = 16
+void flashState::enter(Command& command) {
+    com = &command;
+    offset = end = 0;
+    bq20flash& flash = command.flash;
+    reported = flash.state();
+    String param = cmd.getParamCount() >= 2 ? cmd.getCmdParam(1) : "";
+    if (param == "u") upload(command);
+    else if (param == "") show(command);
+    else if (param == "x") {
+        logstore* file = flash.file();
+        end = file && file->open() ? file->size() : 0;
+    } else if (param != "d" && param != "r") {
+        ansi.println("Use 16 d (dump), 16 r (restore), 16 u offset hex (upload), 16 x (download as hex) or 16 for the state");
+    } else if (command.display == nullptr) {
+        ansi.println("please select '2' (Search address) first");
+    } else if (bqDetect(command.display->address()) != BQTYPE20Z9XX) {
+        ansi.println("The data flash is only reached on a bq20z9xx");
+    } else if (param == "d") {
+        if (flash.dump(command.display->address())) ansi.printf("Dumping subclasses 0 - %u\n", FLASHSUBCLASSES - 1);
+        else ansi.println("Busy, or the image file can not be written");
+    } else {
+        if (flash.restore(command.display->address())) ansi.println("Restoring, only rows which differ are written");
+        else ansi.println("Busy, or no image, use 16 d or 16 u first");
+    }
+    if (flash.state() == bq20flash::DUMPING || flash.state() == bq20flash::RESTORING) reported = flash.state();
+}
+
+// 16 u offset hex: a piece of an image, offset 0 starts a new file; up to 24 bytes fit on a line
+void flashState::upload(Command& command) {
+    if (cmd.getParamCount() < 4) {
+        ansi.println("Use 16 u offset hex");
+        return;
+    }
+    const char* hex = cmd.getCmdParam(3);
+    uint8_t data[32];
+    uint16_t length = 0;
+    for (; isxdigit(hex[0]) && isxdigit(hex[1]) && length < sizeof(data); hex += 2) {
+        char pair[3] {hex[0], hex[1], 0};
+        data[length++] = strtoul(pair, nullptr, 16);
+    }
+    uint32_t offset = cmd.toLong(2);
+    if (command.flash.upload(offset, data, length)) ansi.printf("%u bytes at %lu\n", length, (unsigned long)offset);
+    else ansi.println("Busy, or the image file can not be written");
+}
+
+void flashState::show(Command& command) {
+    bq20flash& flash = command.flash;
+    const char* states[] {"idle", "dumping", "restoring", "done", "failed"};
+    uint16_t rows;
+    ansi.printf("%s, subclass %u, %u rows of %u subclasses, %u compared, %u written, %u failed, %lu ms\n", states[flash.state()],
+                flash.subclass(), flash.rows(), flash.subclasses(), flash.compared(), flash.written(), flash.failures(),
+                (unsigned long)flash.elapsed());
+    if (flash.image(rows)) ansi.printf("Image of %u rows\n", rows);
+    else ansi.println("No image");
+}
+
+// reports the end of a dump or restore, a dump is then printed as hex
+void flashState::update() {
+    bq20flash& flash = com->flash;
+    if (offset < end) printHex(flash.file(), offset, end);
+    if (flash.state() == reported) return;
+    uint8_t started = reported;
+    reported = flash.state();
+    if (reported == bq20flash::FAILED) ansi.println("The image file can not be read or written");
+    if (reported != bq20flash::DONE) return;
+    if (started == bq20flash::DUMPING) {
+        ansi.printf("Dumped %u rows of %u subclasses in %lu ms\n", flash.rows(), flash.subclasses(), (unsigned long)flash.elapsed());
+        if (flash.rows() == 0) ansi.println("No row answered, unseal (5) or use full access (8) first");
+        offset = 0;
+        end = flash.file()->size();
+    } else {
+        ansi.printf("Restored in %lu ms: %u rows compared, %u written, %u failed\n", (unsigned long)flash.elapsed(), flash.compared(),
+                    flash.written(), flash.failures());
+    }
+}
@@ -3,19 +3,19 @@
 #include "../display/display.h"
 #include "../CmdParser/CmdBuffer.hpp"
 #include "../CmdParser/CmdParser.hpp"
+#include "../SMB/SMBQueue.h"
+#include "../SMB/SMBPoller.h"
+#include "../scheduler/scheduler.h"
+#include "../logger/ringlog.h"
+#include "../SMB/SMBHistory.h"
+#include "../SMB/SMBCapture.h"
+#include "../logger/session.h"
+#include "../BQ/BQ20Flash.h"
+#include <optional>
 
-class CommandState;
+#define POLLPRINTMS 1000 /**< Interval of the battery table refresh in the poll state */
 
-class Command{
-public:
-    Command();
-    virtual void handleInput(CmdBuffer<64>);
-    virtual void update();
-    Display* display = {nullptr};
-private:
-    CommandState* state_ {nullptr};
-protected:
-};
+class Command;
 
 class CommandState {
 public:
@@ -55,6 +55,7 @@ public:
     virtual void enter(Command&);
     virtual CommandState* handleInput(Command&, uint8_t);
     virtual void update();
+    void stop() { scanning = false; };
 private:
     bool scanning {false};
     uint32_t key {0x1000};
@@ -80,3 +81,135 @@ public:
     virtual void update();
 };
 
+class pollState : public CommandState {
+public:
+    virtual void enter(Command&);
+    virtual void update();
+private:
+    void print();
+    Command* com;
+    uint32_t printed {0};                       // millis() of the last table
+    uint32_t last[POLLERBATTERIES] {0};         // samples per battery at the last table
+    bool shown {false};
+};
+
+class outputState : public CommandState {
+public:
+    virtual void enter(Command&);
+    virtual void update();
+private:
+    Command* com;
+    uint32_t remaining {0};                     // snapshots still to print
+};
+
+class scheduleState : public CommandState {
+public:
+    virtual void enter(Command&);
+private:
+    void list(Command&);
+};
+
+class logState : public CommandState {
+public:
+    virtual void enter(Command&);
+    virtual void update();
+private:
+    Command* com;
+    uint32_t dumping {0};                       // pages still to print
+    uint32_t page {0};                          // next page to print
+};
+
+class historyState : public CommandState {
+public:
+    virtual void enter(Command&);
+private:
+    void table(Command&);
+};
+
+class captureState : public CommandState {
+public:
+    virtual void enter(Command&);
+    virtual void update();
+private:
+    void arm(Command&);
+    void show(Command&);
+    Command* com;
+    uint16_t dumping {0};                       // samples still to print
+    uint16_t next {0};                          // next sample to print
+};
+
+class recordState : public CommandState {
+public:
+    virtual void enter(Command&);
+    virtual void update();
+private:
+    Command* com;
+    uint32_t offset {0};                        // next byte of the session file to print
+    uint32_t end {0};
+};
+
+class flashState : public CommandState {
+public:
+    virtual void enter(Command&);
+    virtual void update();
+private:
+    void upload(Command&);
+    void show(Command&);
+    Command* com;
+    uint8_t reported {bq20flash::IDLE};         // state of the dump or restore when it was last printed
+    uint32_t offset {0};                        // next byte of the image to print
+    uint32_t end {0};
+};
+
+/**
+ * @struct commandstates
+ * @brief One instance of every state, owned by Command. A transition points to one of them and enter() resets it, so
+ * no state is allocated.
+ */
+struct commandstates {
+    menuState menu;
+    scanState scan;
+    categoryState category;
+    commandnameState commandname;
+    unsealState unseal;
+    sealState seal;
+    clearpfState clearpf;
+    fullaccessState fullaccess;
+    pollState poll;
+    outputState output;
+    scheduleState schedule;
+    logState log;
+    historyState history;
+    captureState capture;
+    recordState record;
+    flashState flash;
+};
+
+class Command{
+public:
+    Command();
+    virtual ~Command();
+    virtual void handleInput(CmdBufferObject&);
+    virtual void update();
+    Display* display = {nullptr}; // display of the selected battery, owned by session
+    batterysession session;
+    commandstates states;
+    sessionrecorder recorder; // wraps the bus and becomes the default transport at the first update(), records after 15 start
+    smbqueue queue;     // background transactions, one is executed per update()
+    bq20flash flash {queue}; // data flash dump and restore, its batches go through the queue
+    smbpoller poller;   // batteries sampled round-robin when the queue is idle
+    scheduler jobs;     // recurring commands, they keep running when the state changes
+    ringlog log;        // time series of the selected battery, filled by a LOG job
+    std::optional<smbhistory> history; // rollups of the selected battery, filled by a HISTORY job
+    std::optional<smbcapture> capture; // triggered capture of the selected battery, sampled by a CAPTURE job while armed
+    void logged(const smbrequest&);
+private:
+    void install();
+    void run(const schedulejob&);
+    void capturing();
+    logsample sample;       // sample of the LOG job being read
+    uint8_t logwaiting {0}; // reads of the sample still queued
+    CommandState* state_ {nullptr};
+    bool installed {false}; // the recorder is the default transport
+protected:
+};
@@ -0,0 +1,243 @@
+/**
+ * @file LinuxTransport.cpp
+ * @author
+ * @brief Function definitions for the Linux i2c-dev transport.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#if defined(__linux__)
+
+#include "LinuxTransport.h"
+#include "SMBPec.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+/**
+ * @brief Constructor, opens the adapter f.e. "/dev/i2c-1".
+ * Use isOpen() to check the result.
+ * @param device
+ */
+linuxtransport::linuxtransport(const char* device) {
+  fd = open(device, O_RDWR);
+  if (fd >= 0 && ioctl(fd, I2C_FUNCS, &functions) < 0) functions = 0;
+}
+
+linuxtransport::~linuxtransport() {
+  if (fd >= 0) close(fd);
+}
+
+bool linuxtransport::isOpen() {
+  return fd >= 0;
+}
+
+/**
+ * @brief Enables the packet error code. I2C_RDWR transfers are checked here, the I2C_SMBUS block read is checked by
+ * the kernel after I2C_PEC is set.
+ * @param enable
+ */
+void linuxtransport::setPec(bool enable) {
+  pec = enable;
+  if (fd >= 0) ioctl(fd, I2C_PEC, (unsigned long)(enable ? 1 : 0));
+}
+
+/**
+ * @brief Checks if a device acknowledges its address, using an SMBus quick write.
+ * @param address
+ * @return uint8_t i2c code
+ */
+uint8_t linuxtransport::probe(uint8_t address) {
+  uint8_t code = select(address);
+  if (code) return code;
+  i2c_smbus_ioctl_data args {I2C_SMBUS_WRITE, 0, I2C_SMBUS_QUICK, nullptr};
+  if (ioctl(fd, I2C_SMBUS, &args) < 0) return errorCode(errno);
+  return SMB_OK;
+}
+
+/**
+ * @brief Read a standard 16-bit register in one I2C_RDWR transfer.
+ * @param address
+ * @param reg
+ * @param data filled with the word read, 0 on error.
+ * @return uint8_t i2c code
+ */
+uint8_t linuxtransport::readWord(uint8_t address, uint8_t reg, uint16_t& data) {
+  data = 0;
+  if (fd < 0) return SMB_OTHER;
+  uint8_t buffer[3] {0};
+  i2c_msg msgs[2] {
+    {address, 0, 1, &reg},
+    {address, I2C_M_RD, (uint16_t)(pec ? 3 : 2), buffer}
+  };
+  i2c_rdwr_ioctl_data transfer {msgs, 2};
+  if (ioctl(fd, I2C_RDWR, &transfer) < 0) return errorCode(errno);
+  data = buffer[0] | buffer[1] << 8;
+  if (pec && buffer[2] != smbpecReadWord(address, reg, data)) return SMB_PEC;
+  return SMB_OK;
+}
+
+/**
+ * @brief Write word to a register in one I2C_RDWR transfer.
+ * @param address
+ * @param reg
+ * @param data
+ * @return uint8_t i2c code
+ */
+uint8_t linuxtransport::writeWord(uint8_t address, uint8_t reg, uint16_t data) {
+  if (fd < 0) return SMB_OTHER;
+  uint8_t buffer[4] {reg, (uint8_t)data, (uint8_t)(data >> 8), smbpecWriteWord(address, reg, data)};
+  i2c_msg msg {address, 0, (uint16_t)(pec ? 4 : 3), buffer};
+  i2c_rdwr_ioctl_data transfer {&msg, 1};
+  if (ioctl(fd, I2C_RDWR, &transfer) < 0) return errorCode(errno);
+  return SMB_OK;
+}
+
+/**
+ * @brief Reads a block of data.
+ * Uses an SMBus block read when the adapter supports it, otherwise length + 1 bytes are read and the first byte is
+ * used as block length, the same way the Wire transport does it. With PEC the longest block and the PEC are read.
+ * @param address
+ * @param reg
+ * @param data
+ * @param length maximum number of bytes to store, on return the number of bytes stored.
+ * @return uint8_t i2c code
+ */
+uint8_t linuxtransport::readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length) {
+  uint8_t max = length;
+  length = 0;
+  if (fd < 0) return SMB_OTHER;
+  uint8_t count;
+  uint8_t buffer[I2C_SMBUS_BLOCK_MAX + 3] {0};
+  if (functions & I2C_FUNC_SMBUS_READ_BLOCK_DATA) {
+    uint8_t code = select(address);
+    if (code) return code;
+    i2c_smbus_data block;
+    i2c_smbus_ioctl_data args {I2C_SMBUS_READ, reg, I2C_SMBUS_BLOCK_DATA, &block};
+    if (ioctl(fd, I2C_SMBUS, &args) < 0) return errorCode(errno);
+    count = block.block[0];
+    memcpy(buffer + 1, block.block + 1, count);
+  } else {
+    // one extra byte for the length byte; with PEC the longest block is read so the PEC can always be checked
+    uint16_t datalength = (pec || max > I2C_SMBUS_BLOCK_MAX ? I2C_SMBUS_BLOCK_MAX : max) + 1;
+    i2c_msg msgs[2] {
+      {address, 0, 1, &reg},
+      {address, I2C_M_RD, (uint16_t)(datalength + (pec ? 1 : 0)), buffer}
+    };
+    i2c_rdwr_ioctl_data transfer {msgs, 2};
+    if (ioctl(fd, I2C_RDWR, &transfer) < 0) return errorCode(errno);
+    if (pec && buffer[0] > I2C_SMBUS_BLOCK_MAX) return SMB_OTHER;
+    count = buffer[0] < datalength - 1 ? buffer[0] : datalength - 1;
+    // the PEC follows the last byte of the block
+    if (pec && buffer[1 + count] != smbpecReadBlock(address, reg, buffer + 1, count)) return SMB_PEC;
+  }
+  length = count < max ? count : max;
+  memcpy(data, buffer + 1, length);
+  return SMB_OK;
+}
+
+/**
+ * @brief Writes a block of data in one I2C_RDWR message: register, byte count, data and the PEC.
+ * @param address
+ * @param reg
+ * @param data
+ * @param length at most I2C_SMBUS_BLOCK_MAX bytes
+ * @return uint8_t i2c code
+ */
+uint8_t linuxtransport::writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length) {
+  if (fd < 0) return SMB_OTHER;
+  if (length > I2C_SMBUS_BLOCK_MAX) return SMB_TOOLONG;
+  uint8_t buffer[I2C_SMBUS_BLOCK_MAX + 3] {reg, length};
+  memcpy(buffer + 2, data, length);
+  buffer[2 + length] = smbpecWriteBlock(address, reg, data, length);
+  i2c_msg msg {address, 0, (uint16_t)(length + (pec ? 3 : 2)), buffer};
+  i2c_rdwr_ioctl_data transfer {&msg, 1};
+  if (ioctl(fd, I2C_RDWR, &transfer) < 0) return errorCode(errno);
+  return SMB_OK;
+}
+
+/**
+ * @brief Reads several word registers with as few I2C_RDWR ioctls as possible.
+ * Every register is a write message followed by a read message with a repeated start. When the adapter rejects a
+ * combined transfer (f.e. one register is NACKed) the registers of that transfer are read one by one, so every
+ * register still gets its own i2c code.
+ * @param address
+ * @param regs
+ * @param data
+ * @param codes
+ * @param count
+ * @return uint8_t number of registers read without error
+ */
+uint8_t linuxtransport::readWords(uint8_t address, const uint8_t* regs, uint16_t* data, uint8_t* codes, uint8_t count) {
+  if (fd < 0) return smbtransport::readWords(address, regs, data, codes, count);
+  uint8_t good = 0;
+  uint8_t reg[LINUXWORDSPERTRANSFER];
+  uint8_t buffer[LINUXWORDSPERTRANSFER][3];
+  i2c_msg msgs[2 * LINUXWORDSPERTRANSFER];
+  for (uint8_t first = 0; first < count; first += LINUXWORDSPERTRANSFER) {
+    uint8_t n = count - first < LINUXWORDSPERTRANSFER ? count - first : LINUXWORDSPERTRANSFER;
+    for (uint8_t i = 0; i < n; i++) {
+      reg[i] = regs[first + i];
+      msgs[2 * i] = {address, 0, 1, &reg[i]};
+      msgs[2 * i + 1] = {address, I2C_M_RD, (uint16_t)(pec ? 3 : 2), buffer[i]};
+    }
+    i2c_rdwr_ioctl_data transfer {msgs, (uint32_t)(2 * n)};
+    if (ioctl(fd, I2C_RDWR, &transfer) < 0) {
+      good += smbtransport::readWords(address, regs + first, data + first, codes + first, n);
+      continue;
+    }
+    for (uint8_t i = 0; i < n; i++) {
+      data[first + i] = buffer[i][0] | buffer[i][1] << 8;
+      codes[first + i] = SMB_OK;
+      if (pec && buffer[i][2] != smbpecReadWord(address, reg[i], data[first + i])) codes[first + i] = SMB_PEC;
+      else good++;
+    }
+  }
+  return good;
+}
+
+/**
+ * @brief Sets the address used by the I2C_SMBUS ioctl, only when it changed.
+ * @param address
+ * @return uint8_t i2c code
+ */
+uint8_t linuxtransport::select(uint8_t address) {
+  if (fd < 0) return SMB_OTHER;
+  if (address == selected) return SMB_OK;
+  if (ioctl(fd, I2C_SLAVE, (unsigned long)address) < 0) {
+    selected = 0xff;
+    return errorCode(errno);
+  }
+  selected = address;
+  return SMB_OK;
+}
+
+/**
+ * @brief Translates an errno value of the i2c-dev driver into an i2c code.
+ * @param error
+ * @return uint8_t i2c code
+ */
+uint8_t linuxtransport::errorCode(int error) {
+  switch (error) {
+    case ENXIO:
+    case EREMOTEIO:
+      return SMB_NACKADDR;
+    case ETIMEDOUT:
+      return SMB_TIMEOUT;
+    case EMSGSIZE:
+      return SMB_TOOLONG;
+    case EBADMSG:
+      return SMB_PEC;
+    default:
+      return SMB_OTHER;
+  }
+}
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * @file LinuxTransport.h
+ * @author
+ * @brief SMBus transport on top of a Linux i2c-dev adapter (/dev/i2c-N).
+ * Word transfers use a single I2C_RDWR ioctl (write register, repeated start, read), block reads use the
+ * I2C_SMBUS ioctl when the adapter supports it and fall back to I2C_RDWR otherwise. readWords() queues up to
+ * LINUXWORDSPERTRANSFER registers in one I2C_RDWR ioctl, so a snapshot costs a few system calls instead of one per register.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#if defined(__linux__)
+
+#include "SMBTransport.h"
+
+#ifndef LINUXI2CDEVICE
+#define LINUXI2CDEVICE "/dev/i2c-1" /**< Adapter used when no transport is given, the default bus on f.e. a Raspberry Pi */
+#endif
+
+#define LINUXWORDSPERTRANSFER 21 /**< Registers per I2C_RDWR ioctl, the kernel accepts at most 42 messages (I2C_RDWR_IOCTL_MAX_MSGS) */
+
+class linuxtransport : public smbtransport {
+  public:
+  linuxtransport(const char* device);
+  ~linuxtransport();
+  bool isOpen();
+  void setPec(bool enable);
+  uint8_t probe(uint8_t address);
+  uint8_t readWord(uint8_t address, uint8_t reg, uint16_t& data);
+  uint8_t writeWord(uint8_t address, uint8_t reg, uint16_t data);
+  uint8_t readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length);
+  uint8_t writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length);
+  uint8_t readWords(uint8_t address, const uint8_t* regs, uint16_t* data, uint8_t* codes, uint8_t count);
+
+  private:
+  uint8_t select(uint8_t address);
+  uint8_t errorCode(int error);
+
+  int fd {-1};                 // file descriptor of the adapter
+  unsigned long functions {0}; // I2C_FUNCS of the adapter
+  uint8_t selected {0xff};     // address set with I2C_SLAVE, 0xff if none
+};
+
+#endif
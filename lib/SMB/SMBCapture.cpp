@@ -0,0 +1,102 @@
+/**
+ * @file SMBCapture.cpp
+ * @author
+ * @brief Function definitions for the triggered capture.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "SMBCapture.h"
+#include "SMBFlags.h"
+
+smbcapture::smbcapture(uint8_t address, smbtransport* transport) : smbuscommands(address, transport) {
+  setCache(false); // every sample is a fresh read
+}
+
+/**
+ * @brief Clears the ring and starts sampling, the capture triggers when a bit of mask changes in reg.
+ * @param reg watched register, f.e. BATTERYSTATUS or SAFETYSTATUS
+ * @param mask bits of reg which trigger
+ * @param wide reg is a 4 byte block (flag registers of the bq40z6xx) instead of a word
+ */
+void smbcapture::arm(uint8_t reg, uint32_t mask, bool wide) {
+  watch = reg;
+  this->mask = mask;
+  wideregister = wide;
+  head = 0;
+  stored = 0;
+  post = 0;
+  flipped = 0;
+  failed = 0;
+  status = ARMED;
+}
+
+void smbcapture::disarm() {
+  if (status != FROZEN) status = IDLE;
+}
+
+/**
+ * @brief Reads the registers into the ring and checks the trigger. Does nothing when idle or frozen; a sample which
+ * can not be read completely is dropped and counted.
+ * @param now millis()
+ * @return bool false when a register could not be read
+ */
+bool smbcapture::sample(uint32_t now) {
+  if (status == IDLE || status == FROZEN) return true;
+  capturesample value;
+  value.time = now;
+  value.voltage = voltage();
+  bool ok = i2ccode == 0;
+  value.current = current();
+  ok &= i2ccode == 0;
+  value.temperature = temperature();
+  ok &= i2ccode == 0;
+  value.watched = readWatched();
+  ok &= i2ccode == 0;
+  if (!ok) {
+    failed++;
+    return false;
+  }
+  ring[head] = value;
+  head = (head + 1) % CAPTURESAMPLES;
+  if (stored < CAPTURESAMPLES) stored++;
+  if (status == ARMED) {
+    // the first sample only sets the reference
+    if (stored > 1 && ((value.watched ^ previous) & mask)) {
+      flipped = (value.watched ^ previous) & mask;
+      post = CAPTUREPOST;
+      status = post ? TRIGGERED : FROZEN;
+    }
+    previous = value.watched;
+  } else if (--post == 0) status = FROZEN;
+  return true;
+}
+
+/**
+ * @brief Sample of the ring, 0 is the oldest.
+ * @param index below count()
+ * @return const capturesample&
+ */
+const capturesample& smbcapture::at(uint16_t index) {
+  return ring[(head + CAPTURESAMPLES - stored + index) % CAPTURESAMPLES];
+}
+
+/**
+ * @brief Index of the sample which triggered, counted like at().
+ * @return int16_t -1 before the trigger
+ */
+int16_t smbcapture::triggerIndex() {
+  if (status != TRIGGERED && status != FROZEN) return -1;
+  return stored - 1 - (CAPTUREPOST - post);
+}
+
+// the flag blocks of the bq40z6xx are little endian
+uint32_t smbcapture::readWatched() {
+  if (!wideregister) return (uint16_t)readRegister(watch);
+  uint8_t data[4] {0};
+  readBlock(watch, data, 4);
+  return flagsFromBlock<uint32_t>(data);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file SMBCapture.h
+ * @author
+ * @brief A trigger for the battery like the one of a logic analyzer. While armed, voltage, current, temperature and a
+ * watched status register are sampled into a ring. When a masked bit of the watched register changes, the capture is
+ * triggered, the battery is sampled as fast as the bus allows until the ring holds CAPTUREPOST samples after the
+ * trigger, and then the capture is frozen for download. The frozen ring holds up to CAPTUREPRE samples before the
+ * trigger, the trigger sample and the samples after it.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include "SMBCommands.h"
+
+#define CAPTURESAMPLES 192                              /**< Samples in the ring, 16 bytes each */
+#define CAPTUREPRE     96                               /**< Samples kept before the trigger */
+#define CAPTUREPOST    (CAPTURESAMPLES - CAPTUREPRE - 1) /**< Samples taken after the trigger sample */
+
+/**
+ * @struct capturesample
+ * @brief One sample of the capture, the values as read.
+ */
+struct capturesample {
+  uint32_t time;          /**< millis() */
+  uint32_t watched;       /**< watched register, 32 bits for the flag blocks of the bq40z6xx */
+  uint16_t voltage;       /**< mV */
+  int16_t current;        /**< mA */
+  uint16_t temperature;   /**< 0.1K */
+};
+
+class smbcapture : public smbuscommands {
+  public:
+  enum {
+    IDLE = 0,   /**< Not sampling */
+    ARMED,      /**< Sampling into the ring, waiting for the trigger */
+    TRIGGERED,  /**< Sampling at full rate until the post-trigger samples are taken */
+    FROZEN,     /**< Capture complete, kept until the next arm */
+  };
+  smbcapture(uint8_t address, smbtransport* transport = nullptr);
+  void arm(uint8_t reg, uint32_t mask, bool wide);
+  void disarm();
+  bool sample(uint32_t now);
+  uint8_t state() { return status; };
+  uint8_t watchedRegister() { return watch; };
+  uint32_t watchedMask() { return mask; };
+  uint16_t count() { return stored; };
+  const capturesample& at(uint16_t index);
+  int16_t triggerIndex();
+  uint32_t triggerBits() { return flipped; };
+  uint32_t errors() { return failed; };
+
+  private:
+  uint32_t readWatched();
+
+  capturesample ring[CAPTURESAMPLES];
+  uint16_t head {0};      // next slot
+  uint16_t stored {0};
+  uint16_t post {0};      // samples after the trigger still to take
+  uint8_t status {IDLE};
+  uint8_t watch {BATTERYSTATUS};
+  uint32_t mask {0};
+  bool wideregister {false};
+  uint32_t previous {0};
+  uint32_t flipped {0};   // masked bits which changed at the trigger
+  uint32_t failed {0};
+};
@@ -1,19 +1,139 @@
 #include "SMBCommands.h"
 
-smbuscommands::smbuscommands(uint8_t address) {
+/**
+ * @section errorcodes
+ * @brief Holds the description of the various battery status error_codes (see batterystatus).
+ *
+ */
+static const char errorcodes[8][18] PROGMEM {
+  "ok",                 /**< The Smart Battery processed the function code without detecting any errors. */
+  "busy",               /**< The Smart Battery is unable to process the function code at this time. */
+  "reserved",           /**< The Smart Battery detected an attempt to read orwrite to a function code reserved by this version of the specification.
+The Smart Battery detected an attempt to access an unsupported optional manufacturer function code. */
+  "unsupported",        /**< The Smart Battery does not support this function code which is defined in version 1.1 of the specification. */
+  "access denied",      /**< The Smart Battery detected an attempt to write to a read only function code. */
+  "over-, under-flow",  /**< The Smart Battery detected a data overflow or under flow. */
+  "badSize",            /**< The Smart Battery detected an attempt to write to a function code with an incorrect size data block. */
+  "unknown"             /**< The Smart Battery detected an unidentifiable error. */
+};
+
+/**
+ * @brief Text of the error_codes field of batterystatus, codes above 7 are reported as unknown.
+ * @param code
+ * @return const __FlashStringHelper*
+ */
+const __FlashStringHelper* sbsErrorCode(uint8_t code) {
+  return FPSTR(errorcodes[code < 8 ? code : 7]);
+}
+
+smbuscommands::smbuscommands(uint8_t address, smbtransport* transport) : smbus(transport) {
     batteryAddress = address;
 }
 
+/**
+ * @brief Freshness class of a register as given by its descriptor, registers outside the SBS range are never cached.
+ * @param reg
+ * @return uint8_t
+ */
+uint8_t smbuscommands::cacheClass(uint8_t reg) {
+  return sbsDescriptor(reg).cacheclass;
+}
+
+/**
+ * @brief Enable or disable the register cache, disabling also empties it.
+ * @param enable
+ */
+void smbuscommands::setCache(bool enable) {
+  cacheenabled = enable;
+  invalidateCache();
+}
+
+/**
+ * @brief Forget all cached values, f.e. after the battery was replaced.
+ */
+void smbuscommands::invalidateCache() {
+  cached = 0;
+  memset(cacheblocklength, 0, sizeof(cacheblocklength));
+}
+
+void smbuscommands::cacheStore(uint8_t reg, uint16_t data) {
+  if (!cacheenabled || cacheClass(reg) == CACHENONE) return;
+  cacheword[reg] = data;
+  cachetime[reg] = millis();
+  cached |= (uint64_t)1 << reg;
+}
+
+/**
+ * @brief Reads a word register, served from the cache while the value is fresh for its class.
+ * Only values read without error are cached, a value from the cache sets i2ccode to 0.
+ * @param reg
+ * @return int16_t
+ */
 int16_t smbuscommands::readRegister(uint8_t reg) {
-  return smbus::readRegister(reg, batteryAddress);
+  uint8_t type = cacheenabled ? cacheClass(reg) : CACHENONE;
+  if (type != CACHENONE) {
+    if (cached >> reg & 1) {
+      uint32_t age = millis() - cachetime[reg];
+      if (type == CACHESTATIC || (type == CACHESLOW && age < CACHESLOWMS) || (type == CACHEFAST && age < CACHEFASTMS)) {
+        hits++;
+        i2ccode = 0;
+        return cacheword[reg];
+      }
+    }
+    misses++;
+  }
+  int16_t data = smbus::readRegister(reg, batteryAddress);
+  if (!i2ccode) cacheStore(reg, data);
+  return data;
 }
 
+/**
+ * @brief Writes a word register and drops the cached values it may change.
+ * ManufacturerAccess (seal, unseal, reset, ...) and BatteryMode invalidate all values except the static ones. BatteryMode
+ * also selects mAh or 10 mWh, so it drops the static capacity values (DesignCapacity) too.
+ * Use invalidateCache() when the battery itself may have changed.
+ * @param reg
+ * @param data
+ */
 void smbuscommands::writeRegister(uint8_t reg, uint16_t data) {
   smbus::writeRegister(reg, data, batteryAddress);
+  if (reg == MANUFACTURERACCESS || reg == BATTERYMODE) {
+    for (uint8_t i = 0; i < CACHEREGISTERS; i++) {
+      uint8_t unit = sbsDescriptor(i).unit;
+      bool unitchange = reg == BATTERYMODE && (unit == UNITCAPACITY || unit == UNITRATE);
+      if (cacheClass(i) != CACHESTATIC || unitchange) cached &= ~((uint64_t)1 << i);
+    }
+  } else if (reg < CACHEREGISTERS) cached &= ~((uint64_t)1 << reg);
 }
 
+/**
+ * @brief Reads a block register, the names and chemistry (0x20 - 0x22) are read only once.
+ * @param reg
+ * @param data
+ * @param len
+ */
 void smbuscommands::readBlock(uint8_t reg, uint8_t* data, uint8_t len) {
-  smbus::readBlock(reg, data, len, batteryAddress);
+  bool cacheable = cacheenabled && reg >= MANUFACTURERNAME && reg < MANUFACTURERNAME + CACHEBLOCKS;
+  if (cacheable) {
+    uint8_t index = reg - MANUFACTURERNAME;
+    uint8_t count = cacheblocklength[index];
+    if (count) {
+      hits++;
+      i2ccode = 0;
+      count = count - 1 < len ? count - 1 : len;
+      memcpy(data, cacheblock[index], count);
+      if (count < len) data[count] = '\0';
+      return;
+    }
+    misses++;
+  }
+  uint8_t received = smbus::readBlock(reg, data, len, batteryAddress);
+  if (cacheable && !i2ccode) {
+    uint8_t index = reg - MANUFACTURERNAME;
+    uint8_t count = received < BLOCKLENGTH ? received : BLOCKLENGTH; // only the bytes the gauge sent
+    memcpy(cacheblock[index], data, count);
+    cacheblocklength[index] = count + 1; // 0 means not cached
+  }
 }
 
 /**
@@ -24,7 +144,7 @@ void smbuscommands::readBlock(uint8_t reg, uint8_t* data, uint8_t len) {
  * @return uint16_t 
  */
 uint16_t smbuscommands::manufacturerAccess() {
-  return readRegister(MANUFACTURERACCESS);
+  return read<MANUFACTURERACCESS>();
 }
 
 /**
@@ -35,7 +155,7 @@ uint16_t smbuscommands::manufacturerAccess() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::remainingCapacityAlarm() {
-  return readRegister(REMAININGCAPACITYALARM);
+  return read<REMAININGCAPACITYALARM>();
 }
 
 /**
@@ -46,7 +166,7 @@ uint16_t smbuscommands::remainingCapacityAlarm() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::remainingTimeAlarm() {
-  return readRegister(REMAININGTIMEALARM);
+  return read<REMAININGTIMEALARM>();
 }
 
 /**
@@ -56,7 +176,7 @@ uint16_t smbuscommands::remainingTimeAlarm() {
  * @return uint16_t
  */
 uint16_t smbuscommands::batteryMode() {
-  batterymode.raw = readRegister(BATTERYMODE);
+  batterymode.raw = read<BATTERYMODE>();
   return batterymode.raw;
 }
 
@@ -67,7 +187,7 @@ uint16_t smbuscommands::batteryMode() {
  * @return int16_t 
  */
 int16_t smbuscommands::atRate() {
-  return readRegister(ATRATE);
+  return read<ATRATE>();
 }
 
 /**
@@ -77,7 +197,7 @@ int16_t smbuscommands::atRate() {
  * @return uint16_t
  */
 uint16_t smbuscommands::atRateTimeToFull() {
-  return readRegister(ATRATETIMETOFULL);
+  return read<ATRATETIMETOFULL>();
 }
 
 /**
@@ -86,7 +206,7 @@ uint16_t smbuscommands::atRateTimeToFull() {
  * @return uint16_t
  */
 uint16_t smbuscommands::atRateTimeToEmpty() {
-  return readRegister(ATRATETIEMTOEMPTY);
+  return read<ATRATETIEMTOEMPTY>();
 }
 
 /**
@@ -96,7 +216,7 @@ uint16_t smbuscommands::atRateTimeToEmpty() {
  * @return bool
  */
 bool smbuscommands::atRateOK() {
-  return readRegister(ATRATEOK);
+  return read<ATRATEOK>();
 }
 
 /**
@@ -106,7 +226,7 @@ bool smbuscommands::atRateOK() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::temperature() {
-  return readRegister(TEMPERATURE);
+  return read<TEMPERATURE>();
 }
 
 /**
@@ -115,7 +235,7 @@ uint16_t smbuscommands::temperature() {
  * @return float 
  */
 float smbuscommands::temperatureC() {
-  return temperature()/10 - 273.15;
+  return readScaled<TEMPERATURE>() - 273.15;
 }
 
 /**
@@ -124,7 +244,7 @@ float smbuscommands::temperatureC() {
  * @return float 
  */
 float smbuscommands::temperatureF() {
-  return temperature()/10 - 459.67;
+  return readScaled<TEMPERATURE>() * 1.8 - 459.67;
 }
 
 /**
@@ -133,7 +253,7 @@ float smbuscommands::temperatureF() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::voltage() {
-  return readRegister(VOLTAGE);
+  return read<VOLTAGE>();
 }
 
 /**
@@ -142,7 +262,7 @@ uint16_t smbuscommands::voltage() {
  * @return uint16_t 
  */
 int16_t smbuscommands::current() {
-  return readRegister(CURRENT);
+  return read<CURRENT>();
 }
 
 /**
@@ -152,7 +272,7 @@ int16_t smbuscommands::current() {
  * @return uint16_t 
  */
 int16_t smbuscommands::averageCurrent() {
-  return readRegister(AVERAGECURRENT);
+  return read<AVERAGECURRENT>();
 }
 
 /**
@@ -161,7 +281,7 @@ int16_t smbuscommands::averageCurrent() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::maxError() {
-  return readRegister(MAXERROR);
+  return read<MAXERROR>();
 }
 
 /**
@@ -170,7 +290,7 @@ uint16_t smbuscommands::maxError() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::relativeStateOfCharge() {
-  uint16_t data = readRegister(RELATIVESTATEOFCHARGE);
+  uint16_t data = read<RELATIVESTATEOFCHARGE>();
   data &= 0x00ff;
   return data;
 }
@@ -182,7 +302,7 @@ uint16_t smbuscommands::relativeStateOfCharge() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::absoluteStateOfCharge() {
-  uint16_t data = readRegister(ABSOLUTESTATEOFCHARGE);
+  uint16_t data = read<ABSOLUTESTATEOFCHARGE>();
   data &= 0x00ff;
   return data;
 }
@@ -194,7 +314,7 @@ uint16_t smbuscommands::absoluteStateOfCharge() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::remainingCapacity() {
-  return readRegister(REMAININGCAPACITY);
+  return read<REMAININGCAPACITY>();
 }
 
 /**
@@ -204,7 +324,7 @@ uint16_t smbuscommands::remainingCapacity() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::fullCapacity() {
-  return readRegister(FULLCAPACITY);
+  return read<FULLCAPACITY>();
 }
 
 /**
@@ -214,7 +334,7 @@ uint16_t smbuscommands::fullCapacity() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::runTimeToEmpty() {
-  return readRegister(RUNTIMETOEMPTY);
+  return read<RUNTIMETOEMPTY>();
 }
 
 /**
@@ -224,7 +344,7 @@ uint16_t smbuscommands::runTimeToEmpty() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::avgTimeToEmpty() {
-  return readRegister(AVGTIMETOEMPTY);
+  return read<AVGTIMETOEMPTY>();
 }
 
 /**
@@ -233,7 +353,7 @@ uint16_t smbuscommands::avgTimeToEmpty() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::avgTimeToFull() {
-  return readRegister(AVGTIMETOFULL);
+  return read<AVGTIMETOFULL>();
 }
 
 /**
@@ -243,7 +363,7 @@ uint16_t smbuscommands::avgTimeToFull() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::chargingCurrent() {
-  return readRegister(CHARGINGCURRENT);
+  return read<CHARGINGCURRENT>();
 }
 
 /**
@@ -253,7 +373,7 @@ uint16_t smbuscommands::chargingCurrent() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::chargingVoltage() {
-  return readRegister(CHARGINGVOLTAGE);
+  return read<CHARGINGVOLTAGE>();
 }
 
 /**
@@ -268,7 +388,7 @@ uint16_t smbuscommands::chargingVoltage() {
  * @return uint16_t, individual flags can be accessed via 'batterystatus' struct containing the status of each bit in the BatteryStatus register.
  */
 uint16_t smbuscommands::batteryStatus() {
-  batterystatus.raw = readRegister(BATTERYSTATUS);
+  batterystatus.raw = read<BATTERYSTATUS>();
   return batterystatus.raw;
 }
 
@@ -279,7 +399,7 @@ uint16_t smbuscommands::batteryStatus() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::cycleCount() {
-  return readRegister(CYCLECOUNT);
+  return read<CYCLECOUNT>();
 }
 
 /**
@@ -289,7 +409,7 @@ uint16_t smbuscommands::cycleCount() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::designCapacity() {
-  return readRegister(DESIGNCAPACITY);
+  return read<DESIGNCAPACITY>();
 }
 
 /**
@@ -298,7 +418,7 @@ uint16_t smbuscommands::designCapacity() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::designVoltage() {
-  return readRegister(DESIGNVOLTAGE);
+  return read<DESIGNVOLTAGE>();
 }
 
 /**
@@ -308,7 +428,7 @@ uint16_t smbuscommands::designVoltage() {
  * @return const char* 
  */
   char* smbuscommands::specificationInfo() {
-  uint16_t data = readRegister(SPECIFICATIONINFO);
+  uint16_t data = read<SPECIFICATIONINFO>();
   data = (data >> 4) & 0x000f;
   static char* info;
   switch (data) {
@@ -331,7 +451,7 @@ uint16_t smbuscommands::designVoltage() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::manufactureDate() {
-  return readRegister(MANUFACTURERDATE);
+  return read<MANUFACTURERDATE>();
 }
 
 /**
@@ -364,7 +484,7 @@ uint16_t smbuscommands::manufactureYear() {
  * @return uint16_t 
  */
 uint16_t smbuscommands::serialNumber() {
-  return readRegister(SERIALNUMBER);
+  return read<SERIALNUMBER>();
 }
 
 /**
@@ -424,7 +544,7 @@ char* smbuscommands::manufacturerData() {
  * @return uint16_t
  */
 uint16_t smbuscommands::optionalMFGfunction4() {
-  return readRegister(OPTIONALMFGFUNCTION4);
+  return read<OPTIONALMFGFUNCTION4>();
 }
 
 /**
@@ -433,7 +553,7 @@ uint16_t smbuscommands::optionalMFGfunction4() {
  * @return uint16_t
  */
 uint16_t smbuscommands::optionalMFGfunction3() {
-  return readRegister(OPTIONALMFGFUNCTION3);
+  return read<OPTIONALMFGFUNCTION3>();
 }
 
 /**
@@ -442,7 +562,7 @@ uint16_t smbuscommands::optionalMFGfunction3() {
  * @return uint16_t
  */
 uint16_t smbuscommands::optionalMFGfunction2() {
-  return readRegister(OPTIONALMFGFUNCTION2);
+  return read<OPTIONALMFGFUNCTION2>();
 }
 
 /**
@@ -451,10 +571,70 @@ uint16_t smbuscommands::optionalMFGfunction2() {
  * @return uint16_t
  */
 uint16_t smbuscommands::optionalMFGfunction1() {
-  return readRegister(OPTIONALMFGFUNCTION1);
+  return read<OPTIONALMFGFUNCTION1>();
 }
 
 uint8_t smbuscommands::address() {
   return batteryAddress;
 };
 
+
+/**
+ * @brief Order in which readSnapshot() reads the registers.
+ * The values which change all the time come first so they are read close together, the settings and the static
+ * information last. Block registers (0x20 - 0x23) and reserved registers are not part of a snapshot.
+ */
+constexpr uint8_t snapshotplan[] {
+  VOLTAGE, CURRENT, AVERAGECURRENT, TEMPERATURE, BATTERYSTATUS,
+  RELATIVESTATEOFCHARGE, ABSOLUTESTATEOFCHARGE, REMAININGCAPACITY, MAXERROR,
+  OPTIONALMFGFUNCTION4, OPTIONALMFGFUNCTION3, OPTIONALMFGFUNCTION2, OPTIONALMFGFUNCTION1,
+  RUNTIMETOEMPTY, AVGTIMETOEMPTY, AVGTIMETOFULL, CHARGINGCURRENT, CHARGINGVOLTAGE,
+  ATRATE, ATRATETIMETOFULL, ATRATETIEMTOEMPTY, ATRATEOK,
+  BATTERYMODE, REMAININGCAPACITYALARM, REMAININGTIMEALARM, FULLCAPACITY, CYCLECOUNT,
+  DESIGNCAPACITY, DESIGNVOLTAGE, SPECIFICATIONINFO, MANUFACTURERDATE, SERIALNUMBER,
+};
+
+// every register of the plan must be a word register
+constexpr bool snapshotPlanValid() {
+  for (uint8_t reg : snapshotplan) {
+    if (sbsDescriptor(reg).width != 2) return false;
+  }
+  return true;
+}
+static_assert(snapshotPlanValid(), "snapshotplan contains a register which is not a word register");
+
+/**
+ * @brief Reads all SBS word registers 0x01 - 0x3f into one frame.
+ * The registers are handed to the transport in one call, which may queue them in a single transfer. batterymode and
+ * batterystatus are updated from the frame so the units can be chosen without reading BatteryMode() again. The snapshot
+ * always reads the battery and refreshes the register cache.
+ * i2ccode holds the first error of the snapshot, or 0.
+ * @param frame
+ * @return uint8_t number of registers read without error
+ */
+uint8_t smbuscommands::readSnapshot(smbsnapshot& frame) {
+  const uint8_t count = sizeof(snapshotplan);
+  uint16_t data[count];
+  uint8_t codes[count];
+  memset(&frame, 0, sizeof(frame));
+  frame.address = batteryAddress;
+  frame.timestamp = millis();
+  uint32_t start = micros();
+  uint8_t good = bus->readWords(batteryAddress, snapshotplan, data, codes, count);
+  frame.duration = micros() - start;
+  frame.count = count;
+  i2ccode = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t reg = snapshotplan[i];
+    frame.code[reg] = codes[i];
+    countError(reg, codes[i]);
+    if (codes[i] == 0) {
+      frame.word[reg] = data[i];
+      frame.valid |= (uint64_t)1 << reg;
+      cacheStore(reg, data[i]);
+    } else if (i2ccode == 0) i2ccode = codes[i];
+  }
+  if (frame.isValid(BATTERYMODE)) batterymode.raw = frame.word[BATTERYMODE];
+  if (frame.isValid(BATTERYSTATUS)) batterystatus.raw = frame.word[BATTERYSTATUS];
+  return good;
+}
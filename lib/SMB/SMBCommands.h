@@ -12,52 +12,183 @@
 
 #include <Arduino.h>
 #include <string.h>
+#include <type_traits>
 #include "SMBus.h"
 
-#define MANUFACTURERACCESS     0X00
-#define REMAININGCAPACITYALARM 0x01
-#define REMAININGTIMEALARM     0x02
-#define BATTERYMODE            0x03
-#define ATRATE                 0x04
-#define ATRATETIMETOFULL       0x05
-#define ATRATETIEMTOEMPTY      0x06
-#define ATRATEOK               0x07
-#define TEMPERATURE            0x08
-#define VOLTAGE                0x09
-#define CURRENT                0x0a
-#define AVERAGECURRENT         0x0b
-#define MAXERROR               0x0c
-#define RELATIVESTATEOFCHARGE  0x0d
-#define ABSOLUTESTATEOFCHARGE  0x0e
-#define REMAININGCAPACITY      0x0f
-#define FULLCAPACITY           0x10
-#define RUNTIMETOEMPTY         0x11
-#define AVGTIMETOEMPTY         0x12
-#define AVGTIMETOFULL          0x13
-#define CHARGINGCURRENT        0x14
-#define CHARGINGVOLTAGE        0x15
-#define BATTERYSTATUS          0x16
-#define CYCLECOUNT             0x17
-#define DESIGNCAPACITY         0x18
-#define DESIGNVOLTAGE          0x19
-#define SPECIFICATIONINFO      0x1a
-#define MANUFACTURERDATE       0x1b
-#define SERIALNUMBER           0x1c
-                               // 0x1d - 0x1f are reserved
-#define MANUFACTURERNAME       0x20
-#define DEVICENAME             0x21
-#define DEVICECHEMISTRY        0x22
-#define MANUFACTURERDATA       0x23
-                               // 0x25 - 0x2e are reserved
-#define OPTIONALMFGFUNCTION5   0x2f
-#define OPTIONALMFGFUNCTION4   0x3c
-#define OPTIONALMFGFUNCTION3   0x3d
-#define OPTIONALMFGFUNCTION2   0x3e
-#define OPTIONALMFGFUNCTION1   0x3f
+/**
+ * @enum sbsregister
+ * @brief Addresses of the Smart Battery Specification registers, see sbsregisters[] for their properties.
+ */
+enum sbsregister : uint8_t {
+  MANUFACTURERACCESS     = 0x00,
+  REMAININGCAPACITYALARM = 0x01,
+  REMAININGTIMEALARM     = 0x02,
+  BATTERYMODE            = 0x03,
+  ATRATE                 = 0x04,
+  ATRATETIMETOFULL       = 0x05,
+  ATRATETIEMTOEMPTY      = 0x06,
+  ATRATEOK               = 0x07,
+  TEMPERATURE            = 0x08,
+  VOLTAGE                = 0x09,
+  CURRENT                = 0x0a,
+  AVERAGECURRENT         = 0x0b,
+  MAXERROR               = 0x0c,
+  RELATIVESTATEOFCHARGE  = 0x0d,
+  ABSOLUTESTATEOFCHARGE  = 0x0e,
+  REMAININGCAPACITY      = 0x0f,
+  FULLCAPACITY           = 0x10,
+  RUNTIMETOEMPTY         = 0x11,
+  AVGTIMETOEMPTY         = 0x12,
+  AVGTIMETOFULL          = 0x13,
+  CHARGINGCURRENT        = 0x14,
+  CHARGINGVOLTAGE        = 0x15,
+  BATTERYSTATUS          = 0x16,
+  CYCLECOUNT             = 0x17,
+  DESIGNCAPACITY         = 0x18,
+  DESIGNVOLTAGE          = 0x19,
+  SPECIFICATIONINFO      = 0x1a,
+  MANUFACTURERDATE       = 0x1b,
+  SERIALNUMBER           = 0x1c,
+                                // 0x1d - 0x1f are reserved
+  MANUFACTURERNAME       = 0x20,
+  DEVICENAME             = 0x21,
+  DEVICECHEMISTRY        = 0x22,
+  MANUFACTURERDATA       = 0x23,
+                                // 0x25 - 0x2e are reserved
+  OPTIONALMFGFUNCTION5   = 0x2f,
+  OPTIONALMFGFUNCTION4   = 0x3c,
+  OPTIONALMFGFUNCTION3   = 0x3d,
+  OPTIONALMFGFUNCTION2   = 0x3e,
+  OPTIONALMFGFUNCTION1   = 0x3f,
+};
+
+// Freshness classes of the register cache
+#define CACHENONE              0    /**< Always read from the battery */
+#define CACHEFAST              1    /**< Measured values, served for CACHEFASTMS */
+#define CACHESLOW              2    /**< Settings and slowly changing values, served for CACHESLOWMS */
+#define CACHESTATIC            3    /**< Never changes, read once */
+#define CACHEFASTMS            100
+#define CACHESLOWMS            10000
+#define CACHEREGISTERS         0x40 /**< Word registers 0x00 - 0x3f can be cached */
+#define CACHEBLOCKS            3    /**< Block registers 0x20 - 0x22 (names and chemistry) can be cached */
+
+#define SBSREGISTERS           0x40 /**< Registers 0x00 - 0x3f are described in sbsregisters[] */
+
+// Units of a register value
+enum sbsunit : uint8_t {
+  UNITNONE = 0,  /**< Bits or a raw number */
+  UNITMV,        /**< mV */
+  UNITRATE,      /**< mA, or 10mW when BatteryMode capacity_mode is set */
+  UNITCAPACITY,  /**< mAh, or 10mWh when BatteryMode capacity_mode is set */
+  UNITDK,        /**< 0.1 Kelvin */
+  UNITPERCENT,   /**< % */
+  UNITMINUTES,   /**< minutes */
+  UNITCOUNT,     /**< a counter */
+  UNITDATE,      /**< (year - 1980) * 512 + month * 32 + day */
+  UNITTEXT,      /**< a block with a string */
+};
+
+/**
+ * @struct sbsdescriptor
+ * @brief Compile time properties of a register.
+ */
+struct sbsdescriptor {
+  uint8_t width;       /**< 2 for a word, the maximum length for a block, 0 for a reserved register */
+  bool issigned;       /**< The word is two's complement */
+  uint8_t unit;        /**< sbsunit */
+  float scale;         /**< Multiply the value with scale to get V, A, K, ... */
+  uint8_t cacheclass;  /**< CACHENONE .. CACHESTATIC */
+};
+
+/**
+ * @brief Descriptor of every register 0x00 - 0x3f, indexed by register.
+ */
+constexpr sbsdescriptor sbsregisters[SBSREGISTERS] {
+  {2, false, UNITNONE,     1,     CACHENONE},   // 0x00 ManufacturerAccess, a command register
+  {2, false, UNITCAPACITY, 1,     CACHESLOW},   // 0x01 RemainingCapacityAlarm
+  {2, false, UNITMINUTES,  1,     CACHESLOW},   // 0x02 RemainingTimeAlarm
+  {2, false, UNITNONE,     1,     CACHESLOW},   // 0x03 BatteryMode
+  {2, true,  UNITRATE,     1,     CACHENONE},   // 0x04 AtRate, the AtRate registers depend on the written value
+  {2, false, UNITMINUTES,  1,     CACHENONE},   // 0x05 AtRateTimeToFull
+  {2, false, UNITMINUTES,  1,     CACHENONE},   // 0x06 AtRateTimeToEmpty
+  {2, false, UNITNONE,     1,     CACHENONE},   // 0x07 AtRateOK
+  {2, false, UNITDK,       0.1,   CACHEFAST},   // 0x08 Temperature
+  {2, false, UNITMV,       0.001, CACHEFAST},   // 0x09 Voltage
+  {2, true,  UNITRATE,     0.001, CACHEFAST},   // 0x0a Current
+  {2, true,  UNITRATE,     0.001, CACHEFAST},   // 0x0b AverageCurrent
+  {2, false, UNITPERCENT,  1,     CACHESLOW},   // 0x0c MaxError
+  {2, false, UNITPERCENT,  1,     CACHEFAST},   // 0x0d RelativeStateOfCharge
+  {2, false, UNITPERCENT,  1,     CACHEFAST},   // 0x0e AbsoluteStateOfCharge
+  {2, false, UNITCAPACITY, 1,     CACHEFAST},   // 0x0f RemainingCapacity
+  {2, false, UNITCAPACITY, 1,     CACHESLOW},   // 0x10 FullChargeCapacity
+  {2, false, UNITMINUTES,  1,     CACHEFAST},   // 0x11 RunTimeToEmpty
+  {2, false, UNITMINUTES,  1,     CACHEFAST},   // 0x12 AverageTimeToEmpty
+  {2, false, UNITMINUTES,  1,     CACHEFAST},   // 0x13 AverageTimeToFull
+  {2, false, UNITRATE,     0.001, CACHEFAST},   // 0x14 ChargingCurrent
+  {2, false, UNITMV,       0.001, CACHEFAST},   // 0x15 ChargingVoltage
+  {2, false, UNITNONE,     1,     CACHEFAST},   // 0x16 BatteryStatus
+  {2, false, UNITCOUNT,    1,     CACHESLOW},   // 0x17 CycleCount
+  {2, false, UNITCAPACITY, 1,     CACHESTATIC}, // 0x18 DesignCapacity
+  {2, false, UNITMV,       0.001, CACHESTATIC}, // 0x19 DesignVoltage
+  {2, false, UNITNONE,     1,     CACHESTATIC}, // 0x1a SpecificationInfo
+  {2, false, UNITDATE,     1,     CACHESTATIC}, // 0x1b ManufactureDate
+  {2, false, UNITNONE,     1,     CACHESTATIC}, // 0x1c SerialNumber
+  {}, {}, {},                                   // 0x1d - 0x1f reserved
+  {BLOCKLENGTH, false, UNITTEXT, 1, CACHENONE}, // 0x20 ManufacturerName, blocks have their own cache
+  {BLOCKLENGTH, false, UNITTEXT, 1, CACHENONE}, // 0x21 DeviceName
+  {BLOCKLENGTH, false, UNITTEXT, 1, CACHENONE}, // 0x22 DeviceChemistry
+  {BLOCKLENGTH, false, UNITNONE, 1, CACHENONE}, // 0x23 ManufacturerData
+  {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {},   // 0x24 - 0x2e reserved
+  {BLOCKLENGTH, false, UNITNONE, 1, CACHENONE}, // 0x2f OptionalMfgFunction5
+  {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, // 0x30 - 0x3b reserved
+  {2, false, UNITMV,       0.001, CACHEFAST},   // 0x3c OptionalMfgFunction4, cell 4 voltage on TI gauges
+  {2, false, UNITMV,       0.001, CACHEFAST},   // 0x3d OptionalMfgFunction3, cell 3
+  {2, false, UNITMV,       0.001, CACHEFAST},   // 0x3e OptionalMfgFunction2, cell 2
+  {2, false, UNITMV,       0.001, CACHEFAST},   // 0x3f OptionalMfgFunction1, cell 1
+};
+
+/**
+ * @brief Descriptor of a register, a reserved one for registers outside 0x00 - 0x3f.
+ * @param reg
+ * @return constexpr sbsdescriptor
+ */
+constexpr sbsdescriptor sbsDescriptor(uint8_t reg) {
+  return reg < SBSREGISTERS ? sbsregisters[reg] : sbsdescriptor {};
+}
+
+/**
+ * @struct sbstype
+ * @brief C++ type of a word register: int16_t when signed, uint16_t otherwise.
+ */
+template <uint8_t Reg>
+struct sbstype {
+  static_assert(sbsDescriptor(Reg).width == 2, "register is not a word register");
+  using type = typename std::conditional<sbsDescriptor(Reg).issigned, int16_t, uint16_t>::type;
+};
+
+#define SNAPSHOTREGISTERS      0x40 /**< Word registers 0x00 - 0x3f fit in a snapshot, indexed by register */
+
+/**
+ * @struct smbsnapshot
+ * @brief A coherent frame of all SBS word registers, filled by smbuscommands::readSnapshot().
+ * Plain data without pointers so it can be copied, stored or sent as is.
+ */
+struct smbsnapshot {
+  uint32_t timestamp;                  /**< millis() at the start of the read */
+  uint32_t duration;                   /**< Time the read took in us */
+  uint64_t valid;                      /**< Bit n is set when register n was read without error */
+  uint16_t word[SNAPSHOTREGISTERS];    /**< Register value, indexed by register, 0 when not read or on error */
+  uint8_t code[SNAPSHOTREGISTERS];     /**< i2c code per register */
+  uint8_t address;                     /**< Address of the battery */
+  uint8_t count;                       /**< Number of registers read */
+
+  bool isValid(uint8_t reg) const { return reg < SNAPSHOTREGISTERS && (valid >> reg & 1); };
+  uint16_t get(uint8_t reg) const { return reg < SNAPSHOTREGISTERS ? word[reg] : 0; };
+};
 
 class smbuscommands : public smbus {
 public:
-  smbuscommands(uint8_t address);
+  smbuscommands(uint8_t address, smbtransport* transport = nullptr);
   virtual uint16_t manufacturerAccess();  // command 0x00
   uint16_t remainingCapacityAlarm();      // command 0x01
   uint16_t remainingTimeAlarm();          // command 0x02
@@ -144,6 +275,32 @@ public:
   uint16_t optionalMFGfunction2();        // command 0x3e
   uint16_t optionalMFGfunction1();        // command 0x3f
   uint8_t address();
+  uint8_t readSnapshot(smbsnapshot& frame);
+
+  /**
+   * @brief Reads a word register with the type of its descriptor, f.e. read<CURRENT>() returns an int16_t.
+   * @tparam Reg register
+   * @return sbstype<Reg>::type
+   */
+  template <uint8_t Reg>
+  typename sbstype<Reg>::type read() {
+    return static_cast<typename sbstype<Reg>::type>(readRegister(Reg));
+  };
+
+  /**
+   * @brief Reads a word register and applies the scale of its descriptor, f.e. readScaled<VOLTAGE>() returns Volts.
+   * @tparam Reg register
+   * @return float
+   */
+  template <uint8_t Reg>
+  float readScaled() {
+    constexpr float scale = sbsDescriptor(Reg).scale;
+    return read<Reg>() * scale;
+  };
+  void setCache(bool enable);
+  void invalidateCache();
+  uint32_t cacheHits() { return hits; };
+  uint32_t cacheMisses() { return misses; };
 
   protected:
   int16_t readRegister(uint8_t reg);
@@ -151,21 +308,20 @@ public:
   void readBlock(uint8_t reg, uint8_t* data, uint8_t len);
 
   uint8_t batteryAddress;
-};
 
-/**
- * @union errorcodes
- * @brief Holds the description of the various battery status error_codes (see batterystatus).
- *
- */
-static String errorcodes[8] {
-  "ok",                 /**< The Smart Battery processed the function code without detecting any errors. */
-  "busy",               /**< The Smart Battery is unable to process the function code at this time. */
-  "reserved",           /**< The Smart Battery detected an attempt to read orwrite to a function code reserved by this version of the specification.
-The Smart Battery detected an attempt to access an unsupported optional manufacturer function code. */
-  "unsupported",        /**< The Smart Battery does not support this function code which is defined in version 1.1 of the specification. */
-  "access denied",      /**< The Smart Battery detected an attempt to write to a read only function code. */
-  "over-, under-flow",  /**< The Smart Battery detected a data overflow or under flow. */
-  "badSize",            /**< The Smart Battery detected an attempt to write to a function code with an incorrect size data block. */
-  "unknown"             /**< The Smart Battery detected an unidentifiable error. */
+  private:
+  uint8_t cacheClass(uint8_t reg);
+  void cacheStore(uint8_t reg, uint16_t data);
+
+  bool cacheenabled {true};
+  uint64_t cached {0};                     // bit n is set when word[n] holds a value
+  uint16_t cacheword[CACHEREGISTERS];
+  uint32_t cachetime[CACHEREGISTERS];      // millis() of the read
+  uint8_t cacheblock[CACHEBLOCKS][BLOCKLENGTH];
+  uint8_t cacheblocklength[CACHEBLOCKS] {0}; // 0 when not cached
+  uint32_t hits {0};
+  uint32_t misses {0};
 };
+
+// text of the error_codes field of batterystatus, the table is in flash (SMBCommands.cpp)
+const __FlashStringHelper* sbsErrorCode(uint8_t code);
@@ -0,0 +1,51 @@
+/**
+ * @file SMBFlags.h
+ * @author
+ * @brief Decoding of flag registers which are read as a block, and change detection on them. The bq40z6xx sends its
+ * 32 bit status registers (0x50 - 0x54) as 4 byte blocks, least significant byte first.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Assembles a flag register from the bytes of a block, least significant byte first.
+ * @tparam T type of the register, its size is the number of bytes used
+ * @param data at least sizeof(T) bytes
+ * @return T
+ */
+template <typename T>
+T flagsFromBlock(const uint8_t* data) {
+  T value = 0;
+  for (uint8_t i = 0; i < sizeof(T); i++) value |= (T)data[i] << (8 * i);
+  return value;
+}
+
+/**
+ * @struct flagdelta
+ * @brief Last value of a flag register and the bits which flipped when it was read. The first read only sets the
+ * reference, so nothing flipped.
+ */
+template <typename T>
+struct flagdelta {
+  T last {0};
+  T changed {0};  /**< Bits which differ between the last two reads */
+  bool valid {false};
+
+  /**
+   * @brief Takes a new value of the register.
+   * @param value
+   * @return T the bits which flipped since the read before
+   */
+  T update(T value) {
+    changed = valid ? (T)(last ^ value) : 0;
+    last = value;
+    valid = true;
+    return changed;
+  }
+};
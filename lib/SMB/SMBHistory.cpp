@@ -0,0 +1,143 @@
+/**
+ * @file SMBHistory.cpp
+ * @author
+ * @brief Function definitions for the register history and its rollups.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "SMBHistory.h"
+
+void rollup::add(int16_t value) {
+  if (value < min) min = value;
+  if (value > max) max = value;
+  sum += value;
+  count++;
+}
+
+void rollup::merge(const rollup& other) {
+  if (other.count == 0) return;
+  if (other.min < min) min = other.min;
+  if (other.max > max) max = other.max;
+  sum += other.sum;
+  count += other.count;
+}
+
+/**
+ * @brief Adds a sample to the raw ring and to the open buckets.
+ * @param value
+ * @param now millis()
+ */
+void rollupring::add(int16_t value, uint32_t now) {
+  advance(now);
+  raw[rawhead] = value;
+  rawtime[rawhead] = now;
+  rawhead = (rawhead + 1) % HISTORYRAW;
+  if (rawcount < HISTORYRAW) rawcount++;
+  opentens.add(value);
+  openminute.add(value);
+  all.add(value);
+}
+
+// closes the buckets the time has left, a gap longer than a ring fills it with empty buckets once
+void rollupring::advance(uint32_t now) {
+  if (!started) {
+    tensindex = now / HISTORYTENMS;
+    minuteindex = now / HISTORYMINUTEMS;
+    started = true;
+    return;
+  }
+  for (uint32_t n = 0; tensindex < now / HISTORYTENMS; tensindex++, n++) {
+    if (n == HISTORYTENS) {
+      tensindex = now / HISTORYTENMS;
+      break;
+    }
+    tens[tenshead] = opentens;
+    tenshead = (tenshead + 1) % HISTORYTENS;
+    opentens = rollup();
+  }
+  for (uint32_t n = 0; minuteindex < now / HISTORYMINUTEMS; minuteindex++, n++) {
+    if (n == HISTORYMINUTES) {
+      minuteindex = now / HISTORYMINUTEMS;
+      break;
+    }
+    minutes[minuteshead] = openminute;
+    minuteshead = (minuteshead + 1) % HISTORYMINUTES;
+    openminute = rollup();
+  }
+}
+
+// the open bucket and the newest closed ones
+rollup rollupring::collect(const rollup* ring, uint8_t head, uint8_t size, uint8_t buckets, const rollup& open) {
+  rollup result = open;
+  for (uint8_t n = 1; n <= buckets && n <= size; n++) result.merge(ring[(head + size - n) % size]);
+  return result;
+}
+
+/**
+ * @brief Rollup of the last ms. Up to 10 s the raw samples are used, up to 5 minutes the 10 s buckets, up to an hour
+ * the 1 min buckets, beyond that the rollup since the start. With buckets the window is the open bucket plus ms of
+ * closed buckets, so it is up to one bucket longer than asked.
+ * @param ms
+ * @param now millis()
+ * @return rollup
+ */
+rollup rollupring::window(uint32_t ms, uint32_t now) {
+  advance(now);
+  if (ms <= HISTORYTENMS) {
+    rollup result;
+    for (uint8_t n = 1; n <= rawcount; n++) {
+      uint8_t slot = (rawhead + HISTORYRAW - n) % HISTORYRAW;
+      if (now - rawtime[slot] >= ms) break;
+      result.add(raw[slot]);
+    }
+    return result;
+  }
+  if (ms <= (uint32_t)HISTORYTENS * HISTORYTENMS) return collect(tens, tenshead, HISTORYTENS, ms / HISTORYTENMS, opentens);
+  if (ms <= (uint32_t)HISTORYMINUTES * HISTORYMINUTEMS) return collect(minutes, minuteshead, HISTORYMINUTES, ms / HISTORYMINUTEMS, openminute);
+  return all;
+}
+
+int16_t rollupring::last() {
+  return rawcount ? raw[(rawhead + HISTORYRAW - 1) % HISTORYRAW] : 0;
+}
+
+void rollupring::clear() {
+  *this = rollupring();
+}
+
+const uint8_t smbhistory::registers[HISTORYREGISTERS] {VOLTAGE, CURRENT, TEMPERATURE, RELATIVESTATEOFCHARGE};
+
+smbhistory::smbhistory(uint8_t address, smbtransport* transport) : smbuscommands(address, transport) {
+}
+
+/**
+ * @brief Reads the registers and adds them to their rings, a register which can not be read is skipped.
+ * @param now millis()
+ * @return bool false when a register could not be read
+ */
+bool smbhistory::sample(uint32_t now) {
+  bool ok = store(0, voltage(), now);
+  ok &= store(1, current(), now);
+  ok &= store(2, temperature(), now);
+  ok &= store(3, relativeStateOfCharge(), now);
+  return ok;
+}
+
+// adds the value of the getter which was just called, unless it failed
+bool smbhistory::store(uint8_t index, int16_t value, uint32_t now) {
+  if (i2ccode != 0) {
+    failed++;
+    return false;
+  }
+  rings[index].add(value, now);
+  return true;
+}
+
+int8_t smbhistory::index(uint8_t reg) {
+  for (uint8_t i = 0; i < HISTORYREGISTERS; i++) if (registers[i] == reg) return i;
+  return -1;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file SMBHistory.h
+ * @author
+ * @brief Recent values of a few registers in RAM with min / max / average rollups, so questions like the average
+ * current of the last minute or the highest temperature since the start are answered without reading the bus.
+ * Every register has a ring of the last raw samples, a ring of 10 s rollups, a ring of 1 min rollups and a rollup
+ * since the start. The rollups are updated on every insert; a bucket is closed when the time moves into the next one,
+ * a bucket without samples stays empty. Memory is fixed at compile time by the sizes below, about 7 kB for the four
+ * registers.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include "SMBCommands.h"
+
+#define HISTORYRAW       32     /**< Raw samples per register */
+#define HISTORYTENS      30     /**< 10 s rollups per register, 5 minutes */
+#define HISTORYMINUTES   60     /**< 1 min rollups per register, 1 hour */
+#define HISTORYTENMS     10000
+#define HISTORYMINUTEMS  60000
+#define HISTORYREGISTERS 4      /**< Number of registers, see smbhistory::registers */
+
+/**
+ * @struct rollup
+ * @brief Minimum, maximum and sum of the samples of a period.
+ */
+struct rollup {
+  int64_t sum {0};          // wide enough for the rollup since the start, at 1 Hz for years
+  uint32_t count {0};
+  int16_t min {INT16_MAX};
+  int16_t max {INT16_MIN};
+
+  void add(int16_t value);
+  void merge(const rollup& other);
+  int16_t average() const { return count ? (int16_t)(sum / (int64_t)count) : 0; };
+};
+
+/**
+ * @class rollupring
+ * @brief The raw samples and the rollups of one register.
+ */
+class rollupring {
+  public:
+  void add(int16_t value, uint32_t now);
+  rollup window(uint32_t ms, uint32_t now);
+  const rollup& total() { return all; };
+  int16_t last();
+  uint8_t samples() { return rawcount; };
+  void clear();
+
+  private:
+  void advance(uint32_t now);
+  rollup collect(const rollup* ring, uint8_t head, uint8_t size, uint8_t buckets, const rollup& open);
+
+  int16_t raw[HISTORYRAW];
+  uint32_t rawtime[HISTORYRAW];
+  uint8_t rawhead {0};          // next raw slot
+  uint8_t rawcount {0};
+  rollup tens[HISTORYTENS];     // closed 10 s buckets, tenshead is the next slot
+  rollup minutes[HISTORYMINUTES];
+  uint8_t tenshead {0};
+  uint8_t minuteshead {0};
+  rollup opentens;              // bucket of the current 10 s
+  rollup openminute;
+  uint32_t tensindex {0};       // millis() / HISTORYTENMS of opentens
+  uint32_t minuteindex {0};
+  rollup all;
+  bool started {false};
+};
+
+/**
+ * @class smbhistory
+ * @brief Samples voltage, current, temperature and relative state of charge of one battery through the getters and
+ * keeps their rollups.
+ */
+class smbhistory : public smbuscommands {
+  public:
+  smbhistory(uint8_t address, smbtransport* transport = nullptr);
+  bool sample(uint32_t now);
+  rollupring& ring(uint8_t index) { return rings[index]; };
+  int8_t index(uint8_t reg);
+  uint32_t errors() { return failed; };
+
+  static const uint8_t registers[HISTORYREGISTERS];
+
+  private:
+  bool store(uint8_t index, int16_t value, uint32_t now);
+
+  rollupring rings[HISTORYREGISTERS];
+  uint32_t failed {0};
+};
@@ -0,0 +1,34 @@
+/**
+ * @file SMBPec.h
+ * @author
+ * @brief SMBus packet error code (PEC): a CRC-8 with polynomial x^8 + x^2 + x + 1 over every byte of a transaction,
+ * including the address bytes. The CRC is computed with a 256 entry table, one lookup per byte.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define SMBPECPOLYNOMIAL 0x07 /**< x^8 + x^2 + x + 1 */
+
+extern const uint8_t smbpectable[256];
+
+/**
+ * @brief Adds one byte to a running PEC.
+ * @param crc PEC so far, 0 at the start of a transaction
+ * @param data
+ * @return uint8_t
+ */
+inline uint8_t smbpec(uint8_t crc, uint8_t data) {
+  return smbpectable[crc ^ data];
+}
+
+uint8_t smbpec(uint8_t crc, const uint8_t* data, uint8_t length);
+uint8_t smbpecReadWord(uint8_t address, uint8_t reg, uint16_t data);
+uint8_t smbpecWriteWord(uint8_t address, uint8_t reg, uint16_t data);
+uint8_t smbpecReadBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length);
+uint8_t smbpecWriteBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length);
@@ -0,0 +1,88 @@
+/**
+ * @file SMBPoller.cpp
+ * @author
+ * @brief Function definitions for the round-robin battery poller.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <Arduino.h>
+#include "SMBPoller.h"
+#include "SMBus.h"
+#include "SMBCommands.h"
+
+// the values which change, in the order they are sampled
+const uint8_t smbpoller::registers[POLLERREGISTERS] {
+  VOLTAGE,
+  CURRENT,
+  RELATIVESTATEOFCHARGE,
+  TEMPERATURE,
+  REMAININGCAPACITY,
+  BATTERYSTATUS,
+};
+
+/**
+ * @brief Adds a battery to the table.
+ * @param address
+ * @param transport, nullptr for the default transport of smbus
+ * @return true if added, false if the table is full or the battery is already in it
+ */
+bool smbpoller::add(uint8_t address, smbtransport* transport) {
+  if (transport == nullptr) transport = smbus::defaultTransport();
+  for (uint8_t i = 0; i < batteries; i++) {
+    if (table[i].bus == transport && table[i].address == address) return false;
+  }
+  if (batteries == POLLERBATTERIES) return false;
+  table[batteries] = smbbattery();
+  table[batteries].bus = transport;
+  table[batteries].address = address;
+  batteries++;
+  return true;
+}
+
+/**
+ * @brief Empties the table.
+ */
+void smbpoller::clear() {
+  batteries = next = reg = 0;
+  total = 0;
+}
+
+/**
+ * @brief Reads one register of one battery. The battery changes every call, the register after every battery had its
+ * turn, so with n batteries every pack is sampled once in n calls.
+ * @return true if a read was executed
+ */
+bool smbpoller::poll() {
+  if (batteries == 0) return false;
+  smbbattery& battery = table[next];
+  uint16_t data;
+  uint8_t code = battery.bus->readWord(battery.address, registers[reg], data);
+  battery.code[reg] = code;
+  battery.time[reg] = millis() | 1; // 0 means never read
+  if (code == 0) {
+    battery.word[reg] = data;
+    battery.samples++;
+    total++;
+  } else battery.errors++;
+  if (++next == batteries) {
+    next = 0;
+    reg = (reg + 1) % POLLERREGISTERS;
+  }
+  return true;
+}
+
+/**
+ * @brief Position of a register in smbbattery::word.
+ * @param reg
+ * @return int8_t index, -1 if the register is not polled
+ */
+int8_t smbpoller::index(uint8_t reg) {
+  for (uint8_t i = 0; i < POLLERREGISTERS; i++) {
+    if (registers[i] == reg) return i;
+  }
+  return -1;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file SMBPoller.h
+ * @author
+ * @brief A table of batteries which are sampled round-robin, one register read per poll().
+ * Every poll() reads the next register of the next battery, so the reads of all packs are interleaved and no pack waits
+ * for a complete dump of another one. Batteries can sit on different transports (secondary buses).
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include "SMBTransport.h"
+
+#define POLLERBATTERIES 8 /**< Number of batteries in the table */
+#define POLLERREGISTERS 6 /**< Number of registers sampled per battery, see smbpoller::registers */
+
+/**
+ * @struct smbbattery
+ * @brief One battery in the table with the last sample of every polled register.
+ */
+struct smbbattery {
+  smbtransport* bus {nullptr};
+  uint8_t address {0};
+  uint16_t word[POLLERREGISTERS] {0};  /**< Last value read, in the order of smbpoller::registers */
+  uint8_t code[POLLERREGISTERS] {0};   /**< i2c code of the last read */
+  uint32_t time[POLLERREGISTERS] {0};  /**< millis() of the last read */
+  uint32_t samples {0};
+  uint32_t errors {0};
+  uint8_t chip {0};                    /**< BQTYPE of the pack, set once by the owner of the table, 0 unknown */
+
+  bool isValid(uint8_t index) { return time[index] != 0 && code[index] == 0; };
+};
+
+class smbpoller {
+  public:
+  bool add(uint8_t address, smbtransport* transport = nullptr);
+  void clear();
+  bool poll();
+  uint8_t count() { return batteries; };
+  smbbattery& battery(uint8_t index) { return table[index]; };
+  uint32_t samples() { return total; };
+  int8_t index(uint8_t reg);
+
+  static const uint8_t registers[POLLERREGISTERS];
+
+  private:
+  smbbattery table[POLLERBATTERIES];
+  uint8_t batteries {0};
+  uint8_t next {0};       // battery read by the next poll()
+  uint8_t reg {0};        // index in registers[] read by the next poll()
+  uint32_t total {0};
+};
@@ -0,0 +1,200 @@
+/**
+ * @file SMBQueue.cpp
+ * @author
+ * @brief Function definitions for the cooperative SMBus transaction queue.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "SMBQueue.h"
+#include "SMBus.h"
+
+/**
+ * @brief Constructor.
+ * @param transport, nullptr for the default transport of smbus. The default is looked up at the first poll(), so a
+ * global queue does not start the bus before setup().
+ */
+smbqueue::smbqueue(smbtransport* transport) {
+  bus = transport;
+}
+
+/**
+ * @brief Puts a request in the next slot, when that slot is free.
+ * Slots are used in a ring, a result which is not collected keeps its slot occupied.
+ * @param request
+ * @return int8_t handle, -1 when the queue is full
+ */
+int8_t smbqueue::submit(const smbrequest& request) {
+  if (requests[tail].state != smbrequest::FREE) return -1;
+  int8_t handle = tail;
+  requests[tail] = request;
+  requests[tail].state = smbrequest::QUEUED;
+  tail = (tail + 1) % SMBQUEUESIZE;
+  queued++;
+  return handle;
+}
+
+/**
+ * @brief Queue the read of a word register.
+ * @param address
+ * @param reg
+ * @param callback called with the result, the slot is freed afterwards. Without a callback collect it with result().
+ * @param context passed to the callback
+ * @return int8_t handle, -1 when the queue is full
+ */
+int8_t smbqueue::submitRead(uint8_t address, uint8_t reg, void (*callback)(const smbrequest&, void*), void* context) {
+  smbrequest request;
+  request.type = smbrequest::READWORD;
+  request.address = address;
+  request.reg = reg;
+  request.callback = callback;
+  request.context = context;
+  return submit(request);
+}
+
+/**
+ * @brief Queue the write of a word register.
+ * @param address
+ * @param reg
+ * @param data
+ * @param callback
+ * @param context
+ * @return int8_t handle, -1 when the queue is full
+ */
+int8_t smbqueue::submitWrite(uint8_t address, uint8_t reg, uint16_t data, void (*callback)(const smbrequest&, void*), void* context) {
+  smbrequest request;
+  request.type = smbrequest::WRITEWORD;
+  request.address = address;
+  request.reg = reg;
+  request.word = data;
+  request.callback = callback;
+  request.context = context;
+  return submit(request);
+}
+
+/**
+ * @brief Queue a block read. The buffer must stay valid until the request is done.
+ * @param address
+ * @param reg
+ * @param data
+ * @param length size of the buffer
+ * @param callback
+ * @param context
+ * @return int8_t handle, -1 when the queue is full
+ */
+int8_t smbqueue::submitBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t length, void (*callback)(const smbrequest&, void*), void* context) {
+  smbrequest request;
+  request.type = smbrequest::READBLOCK;
+  request.address = address;
+  request.reg = reg;
+  request.block = data;
+  request.length = length;
+  request.callback = callback;
+  request.context = context;
+  return submit(request);
+}
+
+/**
+ * @brief Queue a block write. The data is not copied, it must stay valid until the request is done.
+ * @param address
+ * @param reg
+ * @param data
+ * @param length number of bytes
+ * @param callback
+ * @param context
+ * @return int8_t handle, -1 when the queue is full
+ */
+int8_t smbqueue::submitBlockWrite(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length, void (*callback)(const smbrequest&, void*), void* context) {
+  smbrequest request;
+  request.type = smbrequest::WRITEBLOCK;
+  request.address = address;
+  request.reg = reg;
+  request.block = const_cast<uint8_t*>(data); // only read by a block write
+  request.length = length;
+  request.callback = callback;
+  request.context = context;
+  return submit(request);
+}
+
+/**
+ * @brief Executes the next queued transaction, call it from loop().
+ * @return true if a transaction was executed
+ */
+bool smbqueue::poll() {
+  if (queued == 0) return false;
+  if (bus == nullptr) bus = smbus::defaultTransport();
+  smbrequest& request = requests[head];
+  head = (head + 1) % SMBQUEUESIZE;
+  queued--;
+  switch (request.type) {
+    case smbrequest::READWORD:
+      request.code = bus->readWord(request.address, request.reg, request.word);
+      break;
+    case smbrequest::WRITEWORD:
+      request.code = bus->writeWord(request.address, request.reg, request.word);
+      break;
+    case smbrequest::READBLOCK:
+      request.code = bus->readBlock(request.address, request.reg, request.block, request.length);
+      break;
+    case smbrequest::WRITEBLOCK:
+      request.code = bus->writeBlock(request.address, request.reg, request.block, request.length);
+      break;
+  }
+  count++;
+  request.state = smbrequest::DONE;
+  if (request.callback) {
+    request.callback(request, request.context);
+    request.state = smbrequest::FREE;
+  }
+  return true;
+}
+
+/**
+ * @brief Checks if a request has been executed.
+ * @param handle
+ * @return bool
+ */
+bool smbqueue::done(int8_t handle) {
+  return handle >= 0 && handle < SMBQUEUESIZE && requests[handle].state == smbrequest::DONE;
+}
+
+/**
+ * @brief Collects the result of a request and frees its slot.
+ * @param handle
+ * @param data the word read, unchanged for a write
+ * @return uint8_t i2c code, SMB_OTHER when the request is not done
+ */
+uint8_t smbqueue::result(int8_t handle, uint16_t& data) {
+  if (!done(handle)) return SMB_OTHER;
+  if (requests[handle].type == smbrequest::READWORD) data = requests[handle].word;
+  requests[handle].state = smbrequest::FREE;
+  return requests[handle].code;
+}
+
+uint8_t smbqueue::result(int8_t handle) {
+  uint16_t data;
+  return result(handle, data);
+}
+
+/**
+ * @brief Drops all requests, f.e. when the user starts a new command.
+ */
+void smbqueue::clear() {
+  for (smbrequest& request : requests) request.state = smbrequest::FREE;
+  head = tail = queued = 0;
+}
+
+/**
+ * @brief Number of requests waiting to be executed.
+ * @return uint8_t
+ */
+uint8_t smbqueue::pending() {
+  return queued;
+}
+
+bool smbqueue::idle() {
+  return queued == 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file SMBQueue.h
+ * @author
+ * @brief A small queue of SMBus transactions which are executed one at a time from the main loop.
+ * Requests are submitted and return at once; poll() runs at most one transaction on the transport, so a long series of
+ * reads (key search, telemetry) is spread over many loop() passes and the serial input keeps being serviced in
+ * between. The result is collected with result() or delivered to a callback.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include "SMBTransport.h"
+
+#define SMBQUEUESIZE 16 /**< Number of transactions which can be pending or waiting to be collected */
+
+/**
+ * @struct smbrequest
+ * @brief One transaction in the queue.
+ */
+struct smbrequest {
+  enum {
+    FREE = 0,   /**< Slot is unused */
+    QUEUED,     /**< Waiting to be executed */
+    DONE,       /**< Executed, result can be collected */
+  };
+  enum {
+    READWORD = 0,
+    WRITEWORD,
+    READBLOCK,
+    WRITEBLOCK,
+  };
+  uint8_t state {FREE};
+  uint8_t type {READWORD};
+  uint8_t address {0};
+  uint8_t reg {0};
+  uint16_t word {0};        /**< Word to write, or the word read */
+  uint8_t* block {nullptr}; /**< Buffer for a block read, the data of a block write */
+  uint8_t length {0};       /**< Size of the buffer, after the read the number of bytes stored */
+  uint8_t code {0};         /**< i2c code of the transaction */
+  void (*callback)(const smbrequest&, void*) {nullptr};
+  void* context {nullptr};  /**< Passed to the callback */
+};
+
+class smbqueue {
+  public:
+  smbqueue(smbtransport* transport = nullptr);
+  int8_t submitRead(uint8_t address, uint8_t reg, void (*callback)(const smbrequest&, void*) = nullptr, void* context = nullptr);
+  int8_t submitWrite(uint8_t address, uint8_t reg, uint16_t data, void (*callback)(const smbrequest&, void*) = nullptr, void* context = nullptr);
+  int8_t submitBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t length, void (*callback)(const smbrequest&, void*) = nullptr, void* context = nullptr);
+  int8_t submitBlockWrite(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length, void (*callback)(const smbrequest&, void*) = nullptr, void* context = nullptr);
+  bool poll();
+  bool done(int8_t handle);
+  uint8_t result(int8_t handle, uint16_t& data);
+  uint8_t result(int8_t handle);
+  void clear();
+  uint8_t pending();
+  bool idle();
+
+  uint32_t executed() { return count; };
+
+  private:
+  int8_t submit(const smbrequest& request);
+
+  smbtransport* bus;
+  smbrequest requests[SMBQUEUESIZE];
+  uint8_t head {0};      // next request to execute
+  uint8_t tail {0};      // next free slot
+  uint8_t queued {0};    // requests waiting to be executed
+  uint32_t count {0};
+};
@@ -0,0 +1,67 @@
+/**
+ * @file SMBTransport.h
+ * @author
+ * @brief defines the abstract transport the smbus class uses to reach the battery.
+ * A transport only moves bytes: it knows nothing about the Smart Battery registers. This makes it possible to run the
+ * same smbuscommands / bq stack on the Arduino Wire bus or on a Linux i2c-dev adapter.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Result codes of a transaction. The values are the ones returned by Wire.endTransmission() so they can be used as index in i2cCode(),
+// SMB_PEC is added by the transports, SMB_ECHO by the ManufacturerBlockAccess of the bq40z6xx.
+#define SMB_OK       0 /**< Transaction succeeded */
+#define SMB_TOOLONG  1 /**< Data too long to fit in the transmit buffer */
+#define SMB_NACKADDR 2 /**< Address was not acknowledged */
+#define SMB_NACKDATA 3 /**< Data was not acknowledged */
+#define SMB_OTHER    4 /**< Other error */
+#define SMB_TIMEOUT  5 /**< Bus timeout */
+#define SMB_PEC      6 /**< Packet error code did not match, the data is not valid */
+#define SMB_ECHO     7 /**< The response is for another command than the one sent */
+
+class smbtransport {
+  public:
+  virtual ~smbtransport() {};
+
+  /**
+   * @brief Enables the packet error code on word and block transfers, for all devices on this transport.
+   * Reads are checked and fail with SMB_PEC, writes append the PEC byte.
+   * @param enable
+   */
+  virtual void setPec(bool enable) { pec = enable; };
+  bool usesPec() { return pec; };
+
+  virtual uint8_t probe(uint8_t address) = 0;
+  virtual uint8_t readWord(uint8_t address, uint8_t reg, uint16_t& data) = 0;
+  virtual uint8_t writeWord(uint8_t address, uint8_t reg, uint16_t data) = 0;
+  virtual uint8_t readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length) = 0;
+  virtual uint8_t writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length) = 0;
+
+  /**
+   * @brief Reads several word registers in one go, used by smbuscommands::readSnapshot().
+   * The default reads them one by one, a transport which can queue transfers overrides it.
+   * @param address
+   * @param regs registers to read, in this order
+   * @param data filled with the words read, 0 on error
+   * @param codes filled with the i2c code of each register
+   * @param count number of registers
+   * @return uint8_t number of registers read without error
+   */
+  virtual uint8_t readWords(uint8_t address, const uint8_t* regs, uint16_t* data, uint8_t* codes, uint8_t count) {
+    uint8_t good = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      codes[i] = readWord(address, regs[i], data[i]);
+      if (codes[i] == SMB_OK) good++;
+    }
+    return good;
+  };
+
+  protected:
+  bool pec {false};
+};
@@ -10,15 +10,48 @@
  */
 
 #include "SMBus.h"
+#if defined(ARDUINO)
+#include "WireTransport.h"
+#elif defined(__linux__)
+#include "LinuxTransport.h"
+#endif
+
+smbtransport* smbus::defaulttransport {nullptr};
+
+/**
+ * @brief Set the transport used by every smbus object constructed without one.
+ * 
+ * @param transport 
+ */
+void smbus::setDefaultTransport(smbtransport* transport) {
+  defaulttransport = transport;
+}
+
+/**
+ * @brief Get the default transport.
+ * If none was set the Wire bus is used on Arduino and LINUXI2CDEVICE on Linux.
+ * @return smbtransport* 
+ */
+smbtransport* smbus::defaultTransport() {
+  if (defaulttransport == nullptr) {
+#if defined(ARDUINO)
+    static wiretransport wire;
+    defaulttransport = &wire;
+#elif defined(__linux__)
+    static linuxtransport i2cdev(LINUXI2CDEVICE);
+    defaulttransport = &i2cdev;
+#endif
+  }
+  return defaulttransport;
+}
 
 /**
  * @brief Constructor for a new smbus object.
  * 
- * @param none
+ * @param transport, nullptr for the default transport.
  */
-smbus::smbus() {
-  Wire.begin();
-  Wire.setClock(CLOCKSPEED);          
+smbus::smbus(smbtransport* transport) {
+  bus = transport ? transport : defaultTransport();
 }
 
 /**
@@ -28,16 +61,10 @@ smbus::smbus() {
  * @return uint16_t 
  */
 int16_t smbus::readRegister(uint8_t reg, uint8_t address) {
-  Wire.beginTransmission(address);
-  Wire.write(reg);
-  i2ccode = Wire.endTransmission(false);
-  uint8_t datalength = 2;
-  Wire.requestFrom(address, datalength); // Read 2 bytes
-  if(Wire.available()) {
-    return (Wire.read() | Wire.read() << 8);
-  } else {
-    return 0;
-  }
+  uint16_t data;
+  i2ccode = bus->readWord(address, reg, data);
+  countError(reg, i2ccode);
+  return data;
 }
 
 /**
@@ -47,11 +74,8 @@ int16_t smbus::readRegister(uint8_t reg, uint8_t address) {
  * @return void 
  */
 void smbus::writeRegister(uint8_t reg, uint16_t data, uint8_t address) {
-  Wire.beginTransmission(address);
-  Wire.write(reg);
-  Wire.write(lowByte(data));
-  Wire.write(highByte(data));
-  i2ccode = Wire.endTransmission(true);
+  i2ccode = bus->writeWord(address, reg, data);
+  countError(reg, i2ccode);
 }
 
 /**
@@ -60,20 +84,46 @@ void smbus::writeRegister(uint8_t reg, uint16_t data, uint8_t address) {
  * @param reg 
  * @param data 
  * @param length 
+ * @return uint8_t number of bytes received, the bytes after them are not touched except a terminating 0
  */
-void smbus::readBlock(uint8_t reg, uint8_t* data, uint8_t length, uint8_t address) {
-  Wire.beginTransmission(address);
-  Wire.write(reg);
-  i2ccode = Wire.endTransmission(false);
-  uint8_t datalength = length + 1; // Request one extra byte for the length byte
-  uint8_t count = Wire.requestFrom(address, datalength); // returns the number of bytes returned from the peripheral device
-  if (Wire.available()) {
-    count = Wire.read(); // The first byte is the length of the block, it returns the number of bytes received.
-  }
-  for (uint8_t i = 0; i < count && i < length; i++) {
-    if (Wire.available()) {
-      data[i] = Wire.read();
-    }
-  }
-  data[count+1] = '\0'; //terminate the string
+uint8_t smbus::readBlock(uint8_t reg, uint8_t* data, uint8_t length, uint8_t address) {
+  uint8_t count = length;
+  i2ccode = bus->readBlock(address, reg, data, count);
+  countError(reg, i2ccode);
+  if (count < length) data[count] = '\0'; //terminate the string
+  return count;
+}
+
+/**
+ * @brief Writes a block of data to the battery.
+ * @param reg
+ * @param data
+ * @param length number of bytes
+ * @param address
+ */
+void smbus::writeBlock(uint8_t reg, const uint8_t* data, uint8_t length, uint8_t address) {
+  i2ccode = bus->writeBlock(address, reg, data, length);
+  countError(reg, i2ccode);
+}
+
+/**
+ * @brief Enables the packet error code on the transport of this object.
+ * The setting belongs to the transport, so it applies to all batteries on the same bus.
+ * @param enable
+ */
+void smbus::setPec(bool enable) {
+  bus->setPec(enable);
+}
+
+/**
+ * @brief Number of transactions on a register which failed with a PEC error.
+ * @param reg
+ * @return uint16_t
+ */
+uint16_t smbus::pecErrors(uint8_t reg) {
+  return reg < PECREGISTERS ? pecerrors[reg] : 0;
+}
+
+void smbus::countError(uint8_t reg, uint8_t code) {
+  if (code == SMB_PEC && reg < PECREGISTERS && pecerrors[reg] < 0xffff) pecerrors[reg]++;
 }
@@ -10,20 +10,33 @@
  */
 #pragma once
 
-#include <Arduino.h>
-#include <Wire.h>
+#include <stdint.h>
+#include "SMBTransport.h"
 
-#define CLOCKSPEED 130000  /**< Roughly 100kHz */
 #define BLOCKLENGTH 20 /**< Maximum of data stream bytes which may be read */
+#define PECREGISTERS 0x80 /**< PEC errors are counted for registers 0x00 - 0x7f */
 
 class smbus{
+  public:
+  static void setDefaultTransport(smbtransport*);
+  static smbtransport* defaultTransport();
+  void setPec(bool enable);
+  uint16_t pecErrors(uint8_t reg);
+
   protected:
-  smbus();
+  smbus(smbtransport* transport = nullptr);
   virtual int16_t readRegister(uint8_t reg, uint8_t address);
   virtual void writeRegister(uint8_t reg, uint16_t data, uint8_t address);
-  virtual void readBlock(uint8_t reg, uint8_t* data, uint8_t len, uint8_t address);
+  virtual uint8_t readBlock(uint8_t reg, uint8_t* data, uint8_t len, uint8_t address);
+  void writeBlock(uint8_t reg, const uint8_t* data, uint8_t len, uint8_t address);
+  void countError(uint8_t reg, uint8_t code);
 
+  smbtransport* bus; // Transport used to reach the battery
   uint8_t i2ccode; // Error code returned by I2C
+  uint16_t pecerrors[PECREGISTERS] {0}; // PEC failures per register
+
+  private:
+  static smbtransport* defaulttransport;
 };
 
 
@@ -0,0 +1,534 @@
+/**
+ * @file SimTransport.cpp
+ * @author
+ * @brief Function definitions for the simulated smart battery.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "SimTransport.h"
+#include "SMBPec.h"
+#include <math.h>
+#include <string.h>
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+#define SIMDESIGNCAPACITY 4400   /**< mAh */
+#define SIMFULLCAPACITY   4300   /**< mAh */
+#define SIMRESISTANCE     0.1    /**< Ohm, internal resistance of the pack */
+#define SIMOVERTEMP       3282   /**< 55C in 0.1K, sets the over temperature alarm */
+
+// keys as defined in the bq headers
+#define SIMUNSEALA        0x0414
+#define SIMUNSEALB        0x3672
+#define SIMFULLACCESSA    0xffff
+#define SIMFULLACCESSB    0xffff
+#define SIMPFCLEARA       0x2673
+#define SIMPFCLEARB       0x1712
+
+static const char* simnames[2][3] {
+  {"Texas Inst.", "bq20z90", "LION"},
+  {"Texas Inst.", "bq40z60", "LION"},
+};
+
+/**
+ * @brief Busy waits, used to give a transaction the configured latency.
+ * @param us
+ */
+static void simwait(uint32_t us) {
+  if (us == 0) return;
+#if defined(ARDUINO)
+  delayMicroseconds(us);
+#else
+  auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+  while (std::chrono::steady_clock::now() < end);
+#endif
+}
+
+// data flash subclasses of the bq20z9xx: id and size in bytes, as in the bq20z90
+static const uint8_t simsubclasses[SIMSUBCLASSES][2] {
+  {0, 15},  {1, 23},  {2, 14},  {3, 3},   {16, 14}, {17, 6},  {18, 6},  {19, 3},  {20, 10}, {32, 12},
+  {33, 8},  {34, 16}, {35, 10}, {36, 12}, {37, 10}, {38, 22}, {48, 40}, {49, 6},  {56, 22}, {57, 10},
+  {58, 32}, {59, 28}, {60, 3},  {64, 8},  {65, 12}, {67, 10}, {68, 16}, {80, 58}, {81, 12}, {82, 20},
+  {88, 32}, {89, 32}, {90, 32}, {91, 32}, {104, 20}, {105, 8}, {106, 12}, {107, 6}, {112, 16},
+};
+
+/**
+ * @brief Constructor, the battery starts sealed and 95% charged.
+ * @param chip BQ20Z9XX or BQ40Z6XX
+ * @param address SMBus address to answer on
+ */
+simbattery::simbattery(uint8_t type, uint8_t address) : chip(type), own(address) {
+  for (uint16_t i = 0; i < SIMFLASHBYTES; i++) flash[i] = i * 7 + 3;
+  word[0x01] = SIMDESIGNCAPACITY / 10;            // remainingCapacityAlarm
+  word[0x02] = 10;                                // remainingTimeAlarm
+  word[0x03] = 0x6001;                            // batteryMode
+  word[0x05] = 65535;                             // atRateTimeToFull
+  word[0x06] = 65535;                             // atRateTimeToEmpty
+  word[0x07] = 1;                                 // atRateOK
+  word[0x0c] = 1;                                 // maxError
+  word[0x14] = 2000;                              // chargingCurrent
+  word[0x15] = 4200 * SIMCELLS;                   // chargingVoltage
+  word[0x17] = 42;                                // cycleCount
+  word[0x18] = SIMDESIGNCAPACITY;                 // designCapacity
+  word[0x19] = 3600 * SIMCELLS;                   // designVoltage
+  word[0x1a] = 0x0031;                            // specificationInfo, 1.1 with PEC
+  word[0x1b] = (2019 - 1980) * 512 + 6 * 32 + 15; // manufactureDate
+  word[0x1c] = 0x1234;                            // serialNumber
+  word[0x46] = 0x0006;                            // fetControl
+  word[0x4f] = 97;                                // stateOfHealth
+  charge = SIMFULLCAPACITY * 0.95;
+  average = load;
+  update();
+}
+
+/**
+ * @brief Common part of every transaction. Advances the model clock, waits the latency and injects NACKs.
+ * @param address
+ * @param reg
+ * @param bytes number of bytes on the bus, including address and register bytes
+ * @return uint8_t i2c code
+ */
+uint8_t simbattery::begin(uint8_t address, uint8_t reg, uint8_t bytes) {
+  count++;
+  now += bytes * 9 * SIMBITTIME + latency;
+  simwait(latency);
+  update();
+  if (address != own) return SMB_NACKADDR;
+  bool nack = nackevery && (count % nackevery) == 0;
+  if (nackrate) {
+    seed = seed * 1103515245 + 12345;
+    nack |= ((seed >> 16) % 1000) < nackrate;
+  }
+  if (nack) {
+    nackcount++;
+    return SMB_NACKDATA;
+  }
+  // extended commands are not available in sealed mode, but ManufacturerBlockAccess of the bq40z6xx is
+  if (reg >= 0x40 && security == SEALED && !(chip == BQ40Z6XX && reg == 0x44)) return SMB_NACKDATA;
+  return SMB_OK;
+}
+
+/**
+ * @brief Flips a random bit of the data with a chance of corruptrate/1000, as noise on a long wire would.
+ * @param data
+ * @param length
+ */
+void simbattery::corrupt(uint8_t* data, uint8_t length) {
+  if (corruptrate == 0 || length == 0) return;
+  seed = seed * 1103515245 + 12345;
+  if (((seed >> 16) % 1000) >= corruptrate) return;
+  seed = seed * 1103515245 + 12345;
+  uint16_t bit = (seed >> 16) % (length * 8);
+  data[bit / 8] ^= 1 << (bit % 8);
+  corruptcount++;
+}
+
+/**
+ * @brief Lets model time pass without a transaction.
+ * @param ms
+ */
+void simbattery::advance(uint32_t ms) {
+  now += (uint64_t)ms * 1000;
+  update();
+}
+
+/**
+ * @brief Updates the discharge model up to the current simulated time.
+ */
+void simbattery::update() {
+  double dt = (now - updated) / 1e6; // seconds
+  updated = now;
+  double seconds = now / 1e6;
+  // a 10% load ripple with a 30 seconds period
+  double current = load * (1.0 + 0.1 * sin(2 * M_PI * seconds / 30.0));
+  charge += current * dt / 3600.0;
+  if (charge < 0) charge = 0;
+  if (charge > SIMFULLCAPACITY) charge = SIMFULLCAPACITY;
+  if (dt > 0) average += (current - average) * (dt < 60 ? dt / 60.0 : 1.0);
+  temperature = ambient + drift * seconds / 3600.0;
+  if (temperature > ambient + 300) temperature = ambient + 300;
+  if (temperature < ambient - 300) temperature = ambient - 300;
+
+  double soc = charge / SIMFULLCAPACITY;
+  int16_t cell = 3000 + 1200 * soc;
+  word[0x08] = (uint16_t)temperature;
+  word[0x09] = SIMCELLS * cell + current * SIMRESISTANCE;
+  word[0x0a] = (int16_t)current;
+  word[0x0b] = (int16_t)average;
+  word[0x0d] = (uint16_t)(soc * 100 + 0.5);
+  word[0x0e] = (uint16_t)(charge * 100 / SIMDESIGNCAPACITY + 0.5);
+  word[0x0f] = (uint16_t)charge;
+  word[0x10] = SIMFULLCAPACITY;
+  word[0x11] = current < 0 ? (uint16_t)(charge * 60 / -current) : 65535;
+  word[0x12] = average < 0 ? (uint16_t)(charge * 60 / -average) : 65535;
+  word[0x13] = average > 0 ? (uint16_t)((SIMFULLCAPACITY - charge) * 60 / average) : 65535;
+  word[0x16] = batteryStatus();
+  for (uint8_t i = 0; i < SIMCELLS; i++) word[0x3f - i] = cell - 3 * i; // optionalMFGfunction1..4, cell voltages
+}
+
+/**
+ * @brief Composes the BatteryStatus word from the model.
+ * @return uint16_t
+ */
+uint16_t simbattery::batteryStatus() {
+  uint16_t status = 0x0080;                                      // initialized
+  if (word[0x0a] & 0x8000) status |= 0x0040;                     // discharging
+  if (word[0x0d] >= 100) status |= 0x0020;                       // fully charged
+  if (word[0x0d] == 0) status |= 0x0010 | 0x0800;                // fully discharged, terminate discharge
+  if (word[0x0f] < word[0x01]) status |= 0x0200;                 // remaining capacity alarm
+  if (word[0x12] < word[0x02]) status |= 0x0100;                 // remaining time alarm
+  if (word[0x08] >= SIMOVERTEMP) status |= 0x1000;               // over temperature
+  return status;
+}
+
+/**
+ * @brief Composes the bq20z9xx OperationStatus word.
+ * @return uint16_t
+ */
+uint16_t simbattery::operationStatus() {
+  uint16_t status = 0x0001 | 0x0002 | 0x1000;                    // qen, vok, csv
+  if (word[0x16] & 0x0040) status |= 0x0040;                     // dsg
+  if (security == SEALED) status |= 0x2000;                      // ss
+  if (security != FULLACCESS) status |= 0x4000;                  // fas, low means full access
+  return status;
+}
+
+/**
+ * @brief Handles a word written to ManufacturerAccess, a sub-command or one word of a key.
+ * @param command
+ */
+void simbattery::manufacturerAccess(uint16_t command) {
+  uint16_t first = lastkey;
+  lastkey = command;
+  if (first == SIMUNSEALA && command == SIMUNSEALB && security == SEALED) security = UNSEALED;
+  else if (first == SIMFULLACCESSA && command == SIMFULLACCESSB && security == UNSEALED) security = FULLACCESS;
+  else if (first == SIMPFCLEARA && command == SIMPFCLEARB && security != SEALED) pfstatus = 0;
+  macommand = command;
+  responselength = 0;
+  uint16_t value = 0;
+  if (chip == BQ20Z9XX) {
+    switch (command) {
+      case 0x0001: value = 0x0900; break;                        // device type
+      case 0x0002: value = 0x0110; break;                        // firmware version
+      case 0x0003: value = 0x00a7; break;                        // hardware version
+      case 0x0006: value = 0x000a | 1 << 8; break;               // manufacturer status, normal discharge, FETs on
+      case 0x0008: value = 0x0100; break;                        // chemistry id
+      case 0x0020: if (security != SEALED) security = SEALED; break;
+      default: value = command;
+    }
+    word[0x00] = value;
+  } else {
+    switch (command) {
+      case 0x0001: value = 0x4600; responselength = 2; break;    // device type
+      case 0x0002: value = 0x4600; responselength = 11; break;   // firmware version, device number first
+      case 0x0003: value = 0x0002; responselength = 2; break;    // hardware version
+      case 0x0006: value = 0x1202; responselength = 2; break;    // chemistry id
+      case 0x0030: if (security != SEALED) security = SEALED; break;
+      case 0x0035:                                               // security keys, only in full access
+        if (security == FULLACCESS) {
+          uint16_t keys[4] {SIMUNSEALA, SIMUNSEALB, SIMFULLACCESSA, SIMFULLACCESSB};
+          memcpy(response, keys, sizeof(keys));
+          responselength = sizeof(keys);
+        }
+        return;
+      default: break;
+    }
+    memset(response, 0, sizeof(response));
+    response[0] = value;
+    response[1] = value >> 8;
+    word[0x00] = command;
+  }
+}
+
+/**
+ * @brief Fills the contents of a block register.
+ * @param reg
+ * @param data buffer of at least 32 bytes
+ * @return uint8_t the block length, 0 if reg is not a block register
+ */
+uint8_t simbattery::block(uint8_t reg, uint8_t* data) {
+  switch (reg) {
+    case 0x20:
+    case 0x21:
+    case 0x22: {
+      const char* text = simnames[chip][reg - 0x20];
+      memcpy(data, text, strlen(text));
+      return strlen(text);
+    }
+    case 0x23:
+      if (chip == BQ40Z6XX) {
+        memcpy(data, response, responselength);
+        return responselength;
+      } else {
+        // pack lot, pcb lot, firmware, hardware, cell revision, partial/full/watchdog reset counters, checksum
+        uint8_t manufacturerdata[15] {0x21, 0x43, 0x65, 0x87, 0x10, 0x01, 0xa7, 0x00, 0x01, 0x00, 0x02, 0x01, 0x00, 0x5a, 0x0e};
+        memcpy(data, manufacturerdata, sizeof(manufacturerdata));
+        return sizeof(manufacturerdata);
+      }
+    case 0x44:
+      if (chip == BQ40Z6XX) {                                    // ManufacturerBlockAccess, the response follows the sub-command
+        data[0] = macommand & 0xff;
+        data[1] = macommand >> 8;
+        uint8_t length = responselength < 30 ? responselength : 30;
+        memcpy(data + 2, response, length);
+        return 2 + length;
+      }
+      return 0;
+    case 0x50:
+    case 0x51:
+    case 0x52:
+    case 0x53:
+    case 0x54:
+      if (chip == BQ40Z6XX) {                                    // 32 bit flags
+        uint32_t flags = reg == 0x53 ? pfstatus : reg == 0x54 ? (security == SEALED ? 0x0300 : security == UNSEALED ? 0x0200 : 0x0100) : 0;
+        memcpy(data, &flags, 4);
+        return 4;
+      }
+      return 0;
+    case 0x78:
+    case 0x79:
+    case 0x7a:
+    case 0x7b:
+    case 0x7c:
+    case 0x7d:
+    case 0x7e:
+    case 0x7f: {
+      uint8_t length;
+      uint8_t* row = flashRow(reg - 0x78, length);
+      if (row) memcpy(data, row, length);
+      return row ? length : 0;
+    }
+    case 0x60:
+      if (chip == BQ20Z9XX && security == FULLACCESS) {
+        uint8_t key[4] {SIMUNSEALA >> 8, SIMUNSEALA & 0xff, SIMUNSEALB >> 8, SIMUNSEALB & 0xff};
+        memcpy(data, key, 4);
+        return 4;
+      }
+      return 0;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Checks if the simulated battery acknowledges its address.
+ * @param address
+ * @return uint8_t i2c code
+ */
+uint8_t simbattery::probe(uint8_t address) {
+  count++;
+  now += 9 * SIMBITTIME;
+  return address == own ? SMB_OK : SMB_NACKADDR;
+}
+
+/**
+ * @brief Read a standard 16-bit register.
+ * @param address
+ * @param reg
+ * @param data
+ * @return uint8_t i2c code
+ */
+uint8_t simbattery::readWord(uint8_t address, uint8_t reg, uint16_t& data) {
+  data = 0;
+  uint8_t code = begin(address, reg, pec ? 6 : 5);
+  if (code) return code;
+  if (reg >= 0x80 || (reg >= 0x1d && reg <= 0x3b)) return SMB_NACKDATA; // reserved and block registers
+  if (chip == BQ20Z9XX && reg == 0x54) data = operationStatus();
+  else if (chip == BQ20Z9XX && reg == 0x53) data = pfstatus;
+  else data = word[reg];
+  if (!pec) {
+    corrupt(reinterpret_cast<uint8_t*>(&data), 2);
+    return SMB_OK;
+  }
+  uint8_t packet = smbpecReadWord(address, reg, data); // sent by the battery
+  corrupt(reinterpret_cast<uint8_t*>(&data), 2);
+  return packet == smbpecReadWord(address, reg, data) ? SMB_OK : SMB_PEC; // checked by the host
+}
+
+/**
+ * @brief Write word to a register.
+ * Only ManufacturerAccess and the writable SBS registers are accepted.
+ * @param address
+ * @param reg
+ * @param data
+ * @return uint8_t i2c code
+ */
+uint8_t simbattery::writeWord(uint8_t address, uint8_t reg, uint16_t data) {
+  uint8_t code = begin(address, reg, pec ? 5 : 4);
+  if (code) return code;
+  if (pec) {
+    uint8_t packet = smbpecWriteWord(address, reg, data); // sent by the host
+    corrupt(reinterpret_cast<uint8_t*>(&data), 2);
+    if (packet != smbpecWriteWord(address, reg, data)) return SMB_NACKDATA; // the battery NACKs the PEC byte
+  } else corrupt(reinterpret_cast<uint8_t*>(&data), 2);
+  switch (reg) {
+    case 0x00:
+      manufacturerAccess(data);
+      return SMB_OK;
+    case 0x01:
+    case 0x02:
+    case 0x03:
+    case 0x04:
+      word[reg] = data;
+      return SMB_OK;
+    case 0x46:
+      word[reg] = data;
+      return SMB_OK;
+    case 0x77:
+      subclass = -1;
+      for (uint8_t i = 0; chip == BQ20Z9XX && i < SIMSUBCLASSES; i++) {
+        if (simsubclasses[i][0] == data) subclass = i;
+      }
+      return subclass < 0 ? SMB_NACKDATA : SMB_OK;
+    default:
+      return SMB_NACKDATA;
+  }
+}
+
+/**
+ * @brief Row of the selected data flash subclass.
+ * @param page 0 - 7
+ * @param length set to the bytes of the row, 32 except for the last row
+ * @return uint8_t* nullptr when no subclass is selected or it has no such row
+ */
+uint8_t* simbattery::flashRow(uint8_t page, uint8_t& length) {
+  if (chip != BQ20Z9XX || subclass < 0) return nullptr;
+  uint16_t offset = 0;
+  for (int8_t i = 0; i < subclass; i++) offset += simsubclasses[i][1];
+  uint8_t size = simsubclasses[subclass][1];
+  if (page * 32 >= size) return nullptr;
+  length = size - page * 32 < 32 ? size - page * 32 : 32;
+  return flash + offset + page * 32;
+}
+
+/**
+ * @brief Block write, only the data flash rows of the bq20z9xx are writable, a row is written as a whole. A sub-command
+ * written to ManufacturerBlockAccess of the bq40z6xx is handled like one written to ManufacturerAccess.
+ * @param address
+ * @param reg
+ * @param data
+ * @param length
+ * @return uint8_t i2c code
+ */
+uint8_t simbattery::writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length) {
+  uint8_t code = begin(address, reg, 3 + length + (pec ? 1 : 0));
+  if (code) return code;
+  uint8_t buffer[32];
+  if (length > sizeof(buffer)) return SMB_NACKDATA;
+  memcpy(buffer, data, length);
+  uint8_t packet = smbpecWriteBlock(address, reg, buffer, length); // sent by the host
+  corrupt(buffer, length);
+  if (pec && packet != smbpecWriteBlock(address, reg, buffer, length)) return SMB_NACKDATA;
+  if (chip == BQ40Z6XX && reg == 0x44) {
+    if (length < 2) return SMB_NACKDATA;
+    manufacturerAccess(buffer[0] | buffer[1] << 8);
+    return SMB_OK;
+  }
+  uint8_t size;
+  uint8_t* row = reg >= 0x78 && reg <= 0x7f ? flashRow(reg - 0x78, size) : nullptr;
+  if (row == nullptr || size != length) return SMB_NACKDATA;
+  memcpy(row, buffer, length);
+  flashwrites++;
+  return SMB_OK;
+}
+
+/**
+ * @brief Reads a block of data.
+ * @param address
+ * @param reg
+ * @param data
+ * @param length maximum number of bytes to store, on return the number of bytes stored.
+ * @return uint8_t i2c code
+ */
+uint8_t simbattery::readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length) {
+  uint8_t buffer[32];
+  uint8_t size = block(reg, buffer);
+  uint8_t code = begin(address, reg, 4 + size + (pec ? 1 : 0));
+  uint8_t max = length;
+  length = 0;
+  if (code) return code;
+  if (size == 0) return SMB_NACKDATA;
+  uint8_t packet = smbpecReadBlock(address, reg, buffer, size);
+  corrupt(buffer, size);
+  length = size < max ? size : max;
+  memcpy(data, buffer, length);
+  if (pec && packet != smbpecReadBlock(address, reg, buffer, size)) return SMB_PEC;
+  return SMB_OK;
+}
+
+/**
+ * @brief Puts a battery on the bus.
+ * @param battery
+ * @return false if the bus is full
+ */
+bool simbus::attach(simbattery* battery) {
+  if (count == SIMBUSBATTERIES) return false;
+  battery->setPec(pec);
+  batteries[count++] = battery;
+  return true;
+}
+
+void simbus::setPec(bool enable) {
+  pec = enable;
+  for (uint8_t i = 0; i < count; i++) batteries[i]->setPec(enable);
+}
+
+simbattery* simbus::find(uint8_t address) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (batteries[i]->address() == address) return batteries[i];
+  }
+  missed++;
+  return nullptr;
+}
+
+uint8_t simbus::probe(uint8_t address) {
+  simbattery* battery = find(address);
+  return battery ? battery->probe(address) : SMB_NACKADDR;
+}
+
+uint8_t simbus::readWord(uint8_t address, uint8_t reg, uint16_t& data) {
+  simbattery* battery = find(address);
+  return battery ? battery->readWord(address, reg, data) : SMB_NACKADDR;
+}
+
+uint8_t simbus::writeWord(uint8_t address, uint8_t reg, uint16_t data) {
+  simbattery* battery = find(address);
+  return battery ? battery->writeWord(address, reg, data) : SMB_NACKADDR;
+}
+
+uint8_t simbus::readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length) {
+  simbattery* battery = find(address);
+  return battery ? battery->readBlock(address, reg, data, length) : SMB_NACKADDR;
+}
+
+uint8_t simbus::writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length) {
+  simbattery* battery = find(address);
+  return battery ? battery->writeBlock(address, reg, data, length) : SMB_NACKADDR;
+}
+
+/**
+ * @brief Transactions on the bus, including the ones nobody answered.
+ * @return uint32_t
+ */
+uint32_t simbus::transactions() {
+  uint32_t total = missed;
+  for (uint8_t i = 0; i < count; i++) total += batteries[i]->transactions();
+  return total;
+}
+
+/**
+ * @brief Bus time used by all batteries, the batteries share the bus so the times add up.
+ * @return uint64_t
+ */
+uint64_t simbus::simulatedMicros() {
+  uint64_t total = missed * 9 * SIMBITTIME;
+  for (uint8_t i = 0; i < count; i++) total += batteries[i]->simulatedMicros();
+  return total;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file SimTransport.h
+ * @author
+ * @brief A simulated bq20z9xx / bq40z6xx smart battery which can be used instead of a real transport.
+ * The simulator implements the SBS register map of SMBCommands.h and the ManufacturerAccess sub-commands of the
+ * bq headers. Voltage, current, capacity and temperature follow a simple discharge model. The model clock advances with
+ * the time a transaction takes on a 100kHz bus, so the results do not depend on the speed of the host.
+ * Latency, NACKs and corrupted bits can be injected to test and benchmark the whole stack without a battery on the bus.
+ * With PEC enabled the simulator computes the PEC as the battery would and checks it as the host would.
+ * The bq20z9xx has a data flash of SIMSUBCLASSES subclasses with the sizes of the bq20z90, read and written in rows of
+ * 32 bytes through DataFlashClass (0x77) and DataFlashClassSubClass1-8 (0x78 - 0x7f) when not sealed.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include "SMBTransport.h"
+
+#define SIMADDRESS      0x0b   /**< Default SMBus address of a smart battery */
+#define SIMCELLS        4      /**< Number of cells in series */
+#define SIMBITTIME      10     /**< Microseconds per bit at 100kHz */
+#define SIMBUSBATTERIES 8      /**< Number of simulated batteries on one simbus */
+#define SIMSUBCLASSES   39     /**< Data flash subclasses of the bq20z9xx */
+#define SIMFLASHBYTES   651    /**< Data flash bytes of the bq20z9xx, the sum of the subclass sizes */
+
+class simbattery : public smbtransport {
+  public:
+  enum {
+    BQ20Z9XX = 0,
+    BQ40Z6XX,
+  };
+  simbattery(uint8_t chip = BQ20Z9XX, uint8_t address = SIMADDRESS);
+  uint8_t probe(uint8_t address);
+  uint8_t readWord(uint8_t address, uint8_t reg, uint16_t& data);
+  uint8_t writeWord(uint8_t address, uint8_t reg, uint16_t data);
+  uint8_t readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length);
+  uint8_t writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length);
+
+  void setLatency(uint32_t us) { latency = us; };            // extra time each transaction takes, busy waits in real time
+  void setNackEvery(uint32_t n) { nackevery = n; };          // NACK every n-th transaction, 0 = never
+  void setNackRate(uint16_t permille) { nackrate = permille; }; // NACK a random transaction with a chance of permille/1000
+  void setCorruptRate(uint16_t permille) { corruptrate = permille; }; // flip a data bit with a chance of permille/1000
+  void setCurrent(int16_t mA) { load = mA; };                // negative is discharging
+  void setTemperature(uint16_t kelvin10) { ambient = kelvin10; temperature = kelvin10; };  // in 0.1K
+  void setTemperatureDrift(int16_t kelvin10perhour) { drift = kelvin10perhour; };
+  void setSeal(uint8_t mode) { security = mode; };            // SEALED, UNSEALED or FULLACCESS
+  void advance(uint32_t ms);                                 // let model time pass without a transaction
+
+  uint8_t address() { return own; };
+  uint32_t transactions() { return count; };
+  uint32_t nacks() { return nackcount; };
+  uint32_t corruptions() { return corruptcount; };
+  uint32_t flashWrites() { return flashwrites; };            // data flash rows written
+  uint64_t simulatedMicros() { return now; };
+
+  enum {
+    SEALED = 0,
+    UNSEALED,
+    FULLACCESS,
+  };
+
+  private:
+  uint8_t begin(uint8_t address, uint8_t reg, uint8_t bytes);
+  void update();
+  void manufacturerAccess(uint16_t command);
+  uint16_t operationStatus();
+  uint16_t batteryStatus();
+  uint8_t block(uint8_t reg, uint8_t* data);
+  void corrupt(uint8_t* data, uint8_t length);
+  uint8_t* flashRow(uint8_t page, uint8_t& length);
+
+  uint8_t chip;
+  uint8_t own;                    // address the simulator answers on
+  uint8_t security {SEALED};
+  uint16_t word[0x80] {0};        // SBS word registers
+  uint16_t macommand {0};         // last sub-command written to ManufacturerAccess
+  uint16_t lastkey {0};           // first word of a two word key
+  uint8_t response[32] {0};       // ManufacturerAccess response for the bq40z6xx, read via ManufacturerData
+  uint8_t responselength {0};
+  uint32_t pfstatus {0};
+  uint8_t flash[SIMFLASHBYTES];   // data flash of the bq20z9xx, the subclasses one after the other
+  int8_t subclass {-1};           // index of the subclass selected with DataFlashClass, -1 if none
+  uint32_t flashwrites {0};
+
+  uint32_t latency {0};
+  uint32_t nackevery {0};
+  uint16_t nackrate {0};
+  uint16_t corruptrate {0};
+  uint32_t corruptcount {0};
+  uint32_t seed {0x1234567};
+  uint32_t count {0};
+  uint32_t nackcount {0};
+
+  // model
+  uint64_t now {0};               // simulated time in us
+  uint64_t updated {0};           // time of the last model update
+  int16_t load {-1500};           // mean current in mA
+  double charge;                  // remaining capacity in mAh
+  double average;                 // one minute average current
+  uint16_t ambient {2982};
+  double temperature {2982};      // in 0.1K
+  int16_t drift {20};             // 0.1K per hour
+};
+
+/**
+ * @class simbus
+ * @brief A bus with several simulated batteries on different addresses, f.e. a charger with more packs.
+ * A transaction goes to the battery which owns the address, other addresses are not acknowledged.
+ */
+class simbus : public smbtransport {
+  public:
+  bool attach(simbattery* battery);
+  void setPec(bool enable);
+  uint8_t probe(uint8_t address);
+  uint8_t readWord(uint8_t address, uint8_t reg, uint16_t& data);
+  uint8_t writeWord(uint8_t address, uint8_t reg, uint16_t data);
+  uint8_t readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length);
+  uint8_t writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length);
+
+  uint32_t transactions();
+  uint64_t simulatedMicros();
+
+  private:
+  simbattery* find(uint8_t address);
+
+  simbattery* batteries[SIMBUSBATTERIES] {nullptr};
+  uint8_t count {0};
+  uint32_t missed {0};           // transactions to an address without battery
+};
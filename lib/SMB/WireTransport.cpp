@@ -0,0 +1,141 @@
+/**
+ * @file WireTransport.cpp
+ * @author
+ * @brief Function definitions for the Wire transport.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#if defined(ARDUINO)
+
+#include "WireTransport.h"
+
+/**
+ * @brief Constructor, starts the Wire bus.
+ *
+ * @param none
+ */
+wiretransport::wiretransport() {
+  Wire.begin();
+  Wire.setClock(CLOCKSPEED);
+}
+
+/**
+ * @brief Checks if a device acknowledges its address.
+ * @param address
+ * @return uint8_t i2c code
+ */
+uint8_t wiretransport::probe(uint8_t address) {
+  Wire.beginTransmission(address);
+  return Wire.endTransmission();
+}
+
+/**
+ * @brief Read a standard 16-bit register.
+ * @param address
+ * @param reg
+ * @param data filled with the word read, 0 if no data was returned.
+ * @return uint8_t i2c code
+ */
+uint8_t wiretransport::readWord(uint8_t address, uint8_t reg, uint16_t& data) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  uint8_t code = Wire.endTransmission(false);
+  uint8_t datalength = pec ? 3 : 2;
+  Wire.requestFrom(address, datalength); // Read 2 bytes, 3 with PEC
+  if(Wire.available()) {
+    data = (Wire.read() | Wire.read() << 8);
+    if (pec && !code && Wire.read() != smbpecReadWord(address, reg, data)) code = SMB_PEC;
+  } else {
+    data = 0;
+  }
+  return code;
+}
+
+/**
+ * @brief Write word to a register.
+ * @param address
+ * @param reg
+ * @param data
+ * @return uint8_t i2c code
+ */
+uint8_t wiretransport::writeWord(uint8_t address, uint8_t reg, uint16_t data) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  Wire.write(lowByte(data));
+  Wire.write(highByte(data));
+  if (pec) Wire.write(smbpecWriteWord(address, reg, data));
+  return Wire.endTransmission(true);
+}
+
+/**
+ * @brief Reads a block of data.
+ * The first byte returned by the battery is the length of the block, it is not stored. With PEC the whole block is read
+ * into a scratch buffer and checked, a block which arrives incomplete fails with SMB_OTHER, without its PEC with SMB_PEC.
+ * @param address
+ * @param reg
+ * @param data
+ * @param length maximum number of bytes to store, on return the number of bytes stored.
+ * @return uint8_t i2c code
+ */
+uint8_t wiretransport::readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  uint8_t code = Wire.endTransmission(false);
+  if (pec) return readBlockPec(address, reg, data, length, code);
+  uint8_t datalength = length + 1; // Request one extra byte for the length byte
+  uint8_t count = Wire.requestFrom(address, datalength); // returns the number of bytes returned from the peripheral device
+  if (Wire.available()) {
+    count = Wire.read(); // The first byte is the length of the block, it returns the number of bytes received.
+  }
+  uint8_t i = 0;
+  for (; i < count && i < length; i++) {
+    if (Wire.available()) {
+      data[i] = Wire.read();
+    }
+  }
+  length = i;
+  return code;
+}
+
+// the block read of readBlock() with PEC, the register is already written
+uint8_t wiretransport::readBlockPec(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length, uint8_t code) {
+  uint8_t max = length;
+  length = 0;
+  Wire.requestFrom(address, (uint8_t)(BLOCKMAX + 2)); // length byte, block, PEC
+  if (code) return code;
+  if (!Wire.available()) return SMB_OTHER;
+  uint8_t count = Wire.read();
+  if (count > BLOCKMAX) return SMB_OTHER;
+  uint8_t buffer[BLOCKMAX];
+  for (uint8_t i = 0; i < count; i++) {
+    if (!Wire.available()) return SMB_OTHER;
+    buffer[i] = Wire.read();
+  }
+  if (!Wire.available() || Wire.read() != smbpecReadBlock(address, reg, buffer, count)) return SMB_PEC;
+  length = count < max ? count : max;
+  memcpy(data, buffer, length);
+  return SMB_OK;
+}
+
+/**
+ * @brief Writes a block of data, the byte count is sent before the data.
+ * @param address
+ * @param reg
+ * @param data
+ * @param length number of bytes, the Wire buffer holds 32 bytes with the register and the byte count
+ * @return uint8_t i2c code
+ */
+uint8_t wiretransport::writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  Wire.write(length);
+  Wire.write(data, length);
+  if (pec) Wire.write(smbpecWriteBlock(address, reg, data, length));
+  return Wire.endTransmission(true);
+}
+
+#endif
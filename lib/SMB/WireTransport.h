@@ -0,0 +1,36 @@
+/**
+ * @file WireTransport.h
+ * @author
+ * @brief SMBus transport on top of the Arduino Wire library.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "SMBTransport.h"
+#include "SMBPec.h"
+
+#define CLOCKSPEED 130000  /**< Roughly 100kHz */
+#define BLOCKMAX   32      /**< Longest SMBus block */
+
+class wiretransport : public smbtransport {
+  public:
+  wiretransport();
+  uint8_t probe(uint8_t address);
+  uint8_t readWord(uint8_t address, uint8_t reg, uint16_t& data);
+  uint8_t writeWord(uint8_t address, uint8_t reg, uint16_t data);
+  uint8_t readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length);
+  uint8_t writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length);
+
+  private:
+  uint8_t readBlockPec(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length, uint8_t code);
+};
+
+#endif
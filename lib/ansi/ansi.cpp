@@ -22,25 +22,40 @@ ANSI::ANSI(Stream * stream)
 //
 int ANSI::available()
 {
+  flush();  //  a query must be sent before its answer can arrive
   return _stream->available();
 }
 
 
 int ANSI::read()
 {
+  flush();
   return _stream->read();
 }
 
 
 int ANSI::peek()
 {
+  flush();
   return _stream->peek();
 }
 
 
+//  writes the buffered bytes to the stream in one call
 void ANSI::flush()
 {
-  return;
+  if (_length == 0) return;
+  _stream->write(_buffer, _length);
+  _length = 0;
+  _flushes++;
+}
+
+
+//  buffering off writes every byte at once, as the original library did
+void ANSI::setBuffered(bool buffered)
+{
+  flush();
+  _buffered = buffered;
 }
 
 
@@ -50,37 +65,37 @@ void ANSI::flush()
 //
 void ANSI::normal()
 {
-  _stream->write("\033[0m", 4);
+  write("\033[0m", 4);
 }
 
 void ANSI::bold()
 {
-  _stream->write("\033[1m", 4);
+  write("\033[1m", 4);
 }
 
 void ANSI::low()
 {
-  _stream->write("\033[2m", 4);
+  write("\033[2m", 4);
 }
 
 void ANSI::underline()
 {
-  _stream->write("\033[4m", 4);
+  write("\033[4m", 4);
 }
 
 void ANSI::blink()
 {
-  _stream->write("\033[5m", 4);
+  write("\033[5m", 4);
 }
 
 void ANSI::blinkFast()
 {
-  _stream->write("\033[6m", 4);
+  write("\033[6m", 4);
 }
 
 void ANSI::reverse()
 {
-  _stream->write("\033[7m", 4);
+  write("\033[7m", 4);
 }
 
 
@@ -90,57 +105,57 @@ void ANSI::reverse()
 //
 void ANSI::clearScreen()
 {
-  _stream->write("\033[2J\033[H", 7);
+  write("\033[2J\033[H", 7);
 }
 
 void ANSI::clearLine(uint8_t clear)
 {
-  _stream->write("\033[", 2);
+  write("\033[", 2);
   print(clear);
-  _stream->write('K');
+  write('K');
 }
 
 void ANSI::home()
 {
-  _stream->write("\033[H", 3);
+  write("\033[H", 3);
 }
 
 //  changed 0.2.0 see #13
 void ANSI::gotoXY(uint8_t column, uint8_t row)
 {
-  _stream->write("\033[", 2);
+  write("\033[", 2);
   print(row);
-  _stream->write(';');
+  write(';');
   print(column);
-  _stream->write('H');
+  write('H');
 }
 
 void ANSI::cursorUp(uint8_t x)
 {
-  _stream->write("\033[", 2);
+  write("\033[", 2);
   print(x);
-  _stream->write('A');
+  write('A');
 }
 
 void ANSI::cursorDown(uint8_t x)
 {
-  _stream->write("\033[", 2);
+  write("\033[", 2);
   print(x);
-  _stream->write('B');
+  write('B');
 }
 
 void ANSI::cursorForward(uint8_t x)
 {
-  _stream->write("\033[", 2);
+  write("\033[", 2);
   print(x);
-  _stream->write('C');
+  write('C');
 }
 
 void ANSI::cursorBack(uint8_t x)
 {
-  _stream->write("\033[", 2);
+  write("\033[", 2);
   print(x);
-  _stream->write('D');
+  write('D');
 }
 
 
@@ -213,9 +228,9 @@ int ANSI::deviceType(uint32_t timeout)
   uint32_t start = millis();
   while ((len < 3) && ((millis() - start) < timeout))
   {
-    if (_stream->available())
+    if (available())
     {
-      c = _stream->read();
+      c = read();
       buffer[len++] = c;
       buffer[len] = 0;
     }
@@ -239,9 +254,9 @@ bool ANSI::readCursorPosition(uint16_t &w, uint16_t &h, uint32_t timeout)
   uint32_t start = millis();
   while (millis() - start < timeout)
   {
-    if (_stream->available())
+    if (available())
     {
-      c = _stream->read();
+      c = read();
       buffer[len++] = c;
       buffer[len] = 0;
       if (c == 'R') break;
@@ -291,16 +306,25 @@ bool ANSI::getScreenSize(uint16_t &w, uint16_t &h, uint32_t timeout)
 //
 //  PROTECTED
 //
+//  text and escape sequences are collected in the buffer, a newline or a full buffer writes it
 size_t ANSI::write(uint8_t c)
 {
-  //  add line buffer? - interference with write(array, length) !?
-  return _stream->write(c);
+  _bytes++;
+  if (!_buffered)
+  {
+    _flushes++;
+    return _stream->write(c);
+  }
+  _buffer[_length++] = c;
+  if (c == '\n' || _length == ANSI_BUFFER_SIZE) flush();
+  return 1;
 }
 
 
-size_t ANSI::write(uint8_t * array, uint8_t length)
+size_t ANSI::write(const uint8_t * array, size_t length)
 {
-  return _stream->write(array, length);
+  for (size_t i = 0; i < length; i++) write(array[i]);
+  return length;
 }
 
 
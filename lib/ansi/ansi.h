@@ -11,6 +11,7 @@
 #include "Arduino.h"
 
 #define ANSI_LIB_VERSION        (F("0.3.2"))
+#define ANSI_BUFFER_SIZE        128   //  output is collected and written per line or per full buffer
 
 class ANSI : public Stream
 {
@@ -21,7 +22,15 @@ public:
   int  available();
   int  read();
   int  peek();
-  void flush();  //  placeholder to keep CI happy
+  void flush();  //  writes the buffered output
+  size_t write(uint8_t c);
+  size_t write(const uint8_t * array, size_t length);
+  using Print::write;
+
+  //  OUTPUT BUFFER
+  void setBuffered(bool buffered);
+  uint32_t bytesWritten() { return _bytes; };
+  uint32_t flushCount()   { return _flushes; };  //  number of writes to the stream
 
 
   //  CHAR MODES
@@ -183,9 +192,6 @@ public:
 
 
 protected:
-  size_t write(uint8_t c);
-  size_t write(uint8_t * array, uint8_t length);
-
   void color4(uint8_t base, uint8_t color);
   void color4_code(uint8_t base, uint8_t color);
   void colors4(uint8_t fgcolor, uint8_t bgcolor);
@@ -193,6 +199,12 @@ protected:
 
   Stream * _stream;
 
+  uint8_t  _buffer[ANSI_BUFFER_SIZE];
+  uint8_t  _length   = 0;
+  bool     _buffered = true;
+  uint32_t _bytes    = 0;
+  uint32_t _flushes  = 0;
+
   //  screen size parameters
   uint16_t _width = 0;
   uint16_t _height = 0;
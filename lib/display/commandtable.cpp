@@ -0,0 +1,187 @@
+/**
+ * @file commandtable.cpp
+ * @author
+ * @brief The command table and the lookup functions.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "commandtable.h"
+#include <array>
+#include "CommandClassifiers.h"
+#include "records.h"
+#include "../SMB/SMBCommands.h"
+#include "../BQ/BQCommon.h"
+
+/**
+ * @section commandtable
+ * @brief The display functions in menu order. display.cpp holds the function pointers in the same order.
+ *
+ */
+static constexpr commandentry commandtable[COMMANDS] PROGMEM {
+  {"ManufacturerAccess",                    DEVICEINFO,   MANUFACTURERACCESS},
+  {"remainingCapacityAlarm",                USAGEINFO,    REMAININGCAPACITYALARM},
+  {"remainingTimeAlarm",                    USAGEINFO,    REMAININGTIMEALARM},
+  {"batteryMode",                           STATUSBITS,   BATTERYMODE},
+  {"atRate",                                ATRATES,      ATRATE},
+  {"atRateTimeToFull",                      ATRATES,      ATRATETIMETOFULL},
+  {"atRateTimeToEmpty",                     ATRATES,      ATRATETIEMTOEMPTY},
+  {"atRateOK",                              ATRATES,      ATRATEOK},
+  {"temperature",                           USAGEINFO,    TEMPERATURE},
+  {"voltage",                               USAGEINFO,    VOLTAGE},
+  {"current",                               USAGEINFO,    CURRENT},
+  {"averageCurrent",                        USAGEINFO,    AVERAGECURRENT},
+  {"maxError",                              USAGEINFO,    MAXERROR},
+  {"relativeStateOfCharge",                 COMPUTEDINFO, RELATIVESTATEOFCHARGE},
+  {"absoluteStateOfCharge",                 COMPUTEDINFO, ABSOLUTESTATEOFCHARGE},
+  {"remainingCapacity",                     USAGEINFO,    REMAININGCAPACITY},
+  {"fullCapacity",                          DEVICEINFO,   FULLCAPACITY},
+  {"runTimeToEmpty",                        COMPUTEDINFO, RUNTIMETOEMPTY},
+  {"avgTimeToEmpty",                        COMPUTEDINFO, AVGTIMETOEMPTY},
+  {"avgTimeToFull",                         COMPUTEDINFO, AVGTIMETOFULL},
+  {"chargingCurrent",                       USAGEINFO,    CHARGINGCURRENT},
+  {"chargingVoltage",                       USAGEINFO,    CHARGINGVOLTAGE},
+  {"batteryStatus",                         STATUSBITS,   BATTERYSTATUS},
+  {"cycleCount",                            USAGEINFO,    CYCLECOUNT},
+  {"designCapacity",                        DEVICEINFO,   DESIGNCAPACITY},
+  {"designVoltage",                         DEVICEINFO,   DESIGNVOLTAGE},
+  {"specificationInfo",                     DEVICEINFO,   SPECIFICATIONINFO},
+  {"manufactureDate",                       DEVICEINFO,   MANUFACTURERDATE},
+  {"serialNumber",                          DEVICEINFO,   SERIALNUMBER},
+  {"manufacturerName",                      DEVICEINFO,   MANUFACTURERNAME},
+  {"deviceName",                            DEVICEINFO,   DEVICENAME},
+  {"deviceChemistry",                       DEVICEINFO,   DEVICECHEMISTRY},
+  {"optionalMFGfunction_1-4",               USAGEINFO,    NOREGISTER},
+  {"manufacturerAccessType",                DEVICEINFO,   NOREGISTER},
+  {"manufacturerAccessFirmware",            DEVICEINFO,   NOREGISTER},
+  {"manufacturerAccessHardware",            DEVICEINFO,   NOREGISTER},
+  {"manufacturerAccessStatus",              STATUSBITS,   NOREGISTER},
+  {"manufacturerAccessChemistryID",         DEVICEINFO,   NOREGISTER},
+  {"manufacturerAccessShutdown",            SET,          NOREGISTER}, // Instructs the bq20z90/bq20z95 to verify and enter shutdown mode.
+  {"manufacturerAccessSleep",               SET,          NOREGISTER}, // Instructs the bq20z90/bq20z95 to verify and enter sleep mode if no other command is sent after the Sleep command.
+  {"manufacturerAccessSeal",                SET,          NOREGISTER},
+  {"manufacturerAccessPermanentFailClear",  SET,          NOREGISTER},
+  {"manufacturerAccessUnseal",              SET,          NOREGISTER},
+  {"manufacturerAccessFullAccess",          SET,          NOREGISTER},
+  {"manufacturerData",                      DEVICEINFO,   NOREGISTER},
+  {"fetControl",                            SET,          NOREGISTER},
+  {"stateOfHealth",                         STATUSBITS,   NOREGISTER},
+  {"safetyAlert",                           DEVICEINFO,   NOREGISTER, SAFETYALERT},
+  {"safetyStatus",                          STATUSBITS,   NOREGISTER, SAFETYSTATUS},
+  {"pfAlert",                               DEVICEINFO,   NOREGISTER, PFALERT},
+  {"pfStatus",                              STATUSBITS,   NOREGISTER, PFSTATUS},
+  {"operationStatus",                       DEVICEINFO,   NOREGISTER, OPERATIONSTATUS},
+  {"unsealKey",                             DEVICEINFO,   NOREGISTER},
+};
+
+// case-insensitive compare as strcasecmp(), usable at compile time
+static constexpr int compareName(const char* a, const char* b) {
+  for (;; a++, b++) {
+    char x = (*a >= 'A' && *a <= 'Z') ? *a + ('a' - 'A') : *a;
+    char y = (*b >= 'A' && *b <= 'Z') ? *b + ('a' - 'A') : *b;
+    if (x != y || x == 0) return x - y;
+  }
+}
+
+// indices of the table sorted by name, insertion sort at compile time
+static constexpr std::array<uint8_t, COMMANDS> sortCommands() {
+  std::array<uint8_t, COMMANDS> order {};
+  for (uint8_t i = 0; i < COMMANDS; i++) {
+    uint8_t j = i;
+    for (; j > 0 && compareName(commandtable[order[j - 1]].name, commandtable[i].name) > 0; j--) order[j] = order[j - 1];
+    order[j] = i;
+  }
+  return order;
+}
+
+static constexpr std::array<uint8_t, COMMANDS> commandorder PROGMEM = sortCommands();
+
+// two names which differ only in case could not be told apart
+static constexpr bool uniqueNames() {
+  for (uint8_t i = 1; i < COMMANDS; i++) {
+    if (compareName(commandtable[commandorder[i - 1]].name, commandtable[commandorder[i]].name) == 0) return false;
+  }
+  return true;
+}
+static_assert(uniqueNames(), "command names must be unique regardless of case");
+
+const __FlashStringHelper* commandName(uint8_t index) {
+  return FPSTR(commandtable[index].name);
+}
+
+/**
+ * @brief Copies the name to RAM.
+ * @param index
+ * @param buffer of COMMANDNAMESIZE bytes
+ */
+void commandName(uint8_t index, char* buffer) {
+  memcpy_P(buffer, commandtable[index].name, COMMANDNAMESIZE);
+}
+
+uint8_t commandGroup(uint8_t index) {
+  return pgm_read_byte(&commandtable[index].group);
+}
+
+uint8_t commandRegister(uint8_t index) {
+  return pgm_read_byte(&commandtable[index].reg);
+}
+
+/**
+ * @brief Flag register shown by a display function, they are no SBS words and have no register in the reg column.
+ * @param index
+ * @return uint8_t 0x50 - 0x54, NOREGISTER for the other functions
+ */
+uint8_t commandFlags(uint8_t index) {
+  uint8_t reg = pgm_read_byte(&commandtable[index].flags);
+  return reg ? reg : NOREGISTER;
+}
+
+/**
+ * @brief Index of the command at a position in alphabetical order.
+ * @param position
+ * @return uint8_t
+ */
+uint8_t commandSorted(uint8_t position) {
+  return pgm_read_byte(&commandorder[position]);
+}
+
+/**
+ * @brief Looks up a name, case-insensitive.
+ * @param name
+ * @return uint8_t index, NOCOMMAND when not found
+ */
+uint8_t commandFind(const char* name) {
+  uint8_t low = 0, high = COMMANDS;
+  while (low < high) {
+    uint8_t middle = (low + high) / 2;
+    uint8_t index = commandSorted(middle);
+    int result = strcasecmp_P(name, commandtable[index].name);
+    if (result == 0) return index;
+    if (result < 0) high = middle;
+    else low = middle + 1;
+  }
+  return NOCOMMAND;
+}
+
+/**
+ * @brief Finds the names starting with prefix, case-insensitive. The matches are consecutive in alphabetical order.
+ * @param prefix
+ * @param first position of the first match, use commandSorted() to get the index
+ * @return uint8_t number of matches
+ */
+uint8_t commandPrefix(const char* prefix, uint8_t& first) {
+  size_t length = strlen(prefix);
+  uint8_t low = 0, high = COMMANDS;
+  while (low < high) { // first name not below the prefix
+    uint8_t middle = (low + high) / 2;
+    if (strncasecmp_P(prefix, commandtable[commandSorted(middle)].name, length) > 0) low = middle + 1;
+    else high = middle;
+  }
+  first = low;
+  uint8_t count = 0;
+  while (low + count < COMMANDS && strncasecmp_P(prefix, commandtable[commandSorted(low + count)].name, length) == 0) count++;
+  return count;
+}
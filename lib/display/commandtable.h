@@ -0,0 +1,40 @@
+/**
+ * @file commandtable.h
+ * @author
+ * @brief The names of the display functions, their category, register and flag register, as one table in flash.
+ * The table is the same for every chip, the order is the order of the display function pointers in display.cpp. A
+ * second table, sorted case-insensitively at compile time, gives the lookup by name with a binary search; a name can
+ * be given in any case and shortened to a unique prefix.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#define COMMANDS 53         /**< Number of display functions */
+#define COMMANDNAMESIZE 37  /**< Longest name (manufacturerAccessPermanentFailClear) + 1 */
+#define NOCOMMAND 0xff      /**< Result of a lookup without match */
+
+/**
+ * @struct commandentry
+ * @brief One display function.
+ */
+struct commandentry {
+  char name[COMMANDNAMESIZE]; /**< name of the battery function the display function calls */
+  uint8_t group;              /**< category, see CommandClassifiers.h */
+  uint8_t reg;                /**< SBS register shown, NOREGISTER when the function shows more or none */
+  uint8_t flags {0};          /**< flag register (0x50 - 0x54) read as a block, 0 for none */
+};
+
+const __FlashStringHelper* commandName(uint8_t index);
+void commandName(uint8_t index, char* buffer);
+uint8_t commandGroup(uint8_t index);
+uint8_t commandRegister(uint8_t index);
+uint8_t commandFlags(uint8_t index);
+uint8_t commandSorted(uint8_t position);
+uint8_t commandFind(const char* name);
+uint8_t commandPrefix(const char* prefix, uint8_t& first);
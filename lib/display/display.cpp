@@ -1,526 +1,474 @@
 #include "display.h"
 #include <bitset>
+#include "../BQ/BQDetect.h"
 
-Display::Display(uint8_t address): BQICTYPE(address) {
-  // list of the different commands, including function pointers to these funtions. This to be able to call them via user input
-    info.emplace_back(&Display::displaymanufacturerAccess, DEVICEINFO, "ManufacturerAccess");
-    info.emplace_back(&Display::displayremainingCapacityAlarm, USAGEINFO, "remainingCapacityAlarm");
-    info.emplace_back(&Display::displayremainingTimeAlarm, USAGEINFO, "remainingTimeAlarm");
-    info.emplace_back(&Display::displaybatteryMode, STATUSBITS, "batteryMode");
-    info.emplace_back(&Display::displayatRate, ATRATES, "atRate");
-    info.emplace_back(&Display::displayatRateTimeToFull, ATRATES, "atRateTimeToFull");
-    info.emplace_back(&Display::displayatRateTimeToEmpty, ATRATES, "atRateTimeToEmpty");
-    info.emplace_back(&Display::displayatRateOK, ATRATES, "atRateOK");
-    info.emplace_back(&Display::displaytemperature, USAGEINFO, "temperature");
-    info.emplace_back(&Display::displayvoltage, USAGEINFO, "voltage");
-    info.emplace_back(&Display::displaycurrent, USAGEINFO, "current");
-    info.emplace_back(&Display::displayaverageCurrent, USAGEINFO, "averageCurrent");
-    info.emplace_back(&Display::displaymaxError, USAGEINFO, "maxError");
-    info.emplace_back(&Display::displayrelativeStateOfCharge, COMPUTEDINFO, "relativeStateOfCharge");
-    info.emplace_back(&Display::displayabsoluteStateOfCharge, COMPUTEDINFO, "absoluteStateOfCharge");
-    info.emplace_back(&Display::displayremainingCapacity, USAGEINFO, "remainingCapacity");
-    info.emplace_back(&Display::displayfullCapacity, DEVICEINFO, "fullCapacity");
-    info.emplace_back(&Display::displayrunTimeToEmpty, COMPUTEDINFO, "runTimeToEmpty");
-    info.emplace_back(&Display::displayavgTimeToEmpty, COMPUTEDINFO, "avgTimeToEmpty");
-    info.emplace_back(&Display::displayavgTimeToFull, COMPUTEDINFO, "avgTimeToFull");
-    info.emplace_back(&Display::displaychargingCurrent, USAGEINFO, "chargingCurrent");
-    info.emplace_back(&Display::displaychargingVoltage, USAGEINFO, "chargingVoltage");
-    info.emplace_back(&Display::displaybatteryStatus, STATUSBITS, "batteryStatus");
-    info.emplace_back(&Display::displaycycleCount, USAGEINFO, "cycleCount");
-    info.emplace_back(&Display::displaydesignCapacity, DEVICEINFO, "designCapacity");
-    info.emplace_back(&Display::displaydesignVoltage, DEVICEINFO, "designVoltage");
-    info.emplace_back(&Display::displayspecificationInfo, DEVICEINFO, "specificationInfo");
-    info.emplace_back(&Display::displaymanufactureDate, DEVICEINFO, "manufactureDate");
-    info.emplace_back(&Display::displayserialNumber, DEVICEINFO, "serialNumber");
-    info.emplace_back(&Display::displaymanufacturerName, DEVICEINFO, "manufacturerName");
-    info.emplace_back(&Display::displaydeviceName, DEVICEINFO, "deviceName");
-    info.emplace_back(&Display::displaydeviceChemistry, DEVICEINFO, "deviceChemistry");
-    info.emplace_back(&Display::displayoptionalMFGfunctions, USAGEINFO, "optionalMFGfunction_1-4");
-    info.emplace_back(&Display::displaymanufacturerAccessType, DEVICEINFO, "manufacturerAccessType");
-    info.emplace_back(&Display::displaymanufacturerAccessFirmware, DEVICEINFO, "manufacturerAccessFirmware");
-    info.emplace_back(&Display::displaymanufacturerAccessHardware, DEVICEINFO, "manufacturerAccessHardware");
-    info.emplace_back(&Display::displaymanufacturerAccessStatus, STATUSBITS, "manufacturerAccessStatus");
-    info.emplace_back(&Display::displaymanufacturerAccessChemistryID, DEVICEINFO, "manufacturerAccessChemistryID");
-    info.emplace_back(&Display::displaymanufacturerAccessShutdown, SET, "manufacturerAccessShutdown"); // Instructs the bq20z90/bq20z95 to verify and enter shutdown mode.
-    info.emplace_back(&Display::displaymanufacturerAccessSleep, SET, "manufacturerAccessSleep"); // Instructs the bq20z90/bq20z95 to verify and enter sleep mode if no other command is sent after the Sleep command.
-    info.emplace_back(&Display::displaymanufacturerAccessSeal, SET, "manufacturerAccessSeal");
-    info.emplace_back(&Display::displaymanufacturerAccessPermanentFailClear, SET, "manufacturerAccessPermanentFailClear");
-    info.emplace_back(&Display::displaymanufacturerAccessUnseal, SET, "manufacturerAccessUnseal");
-    info.emplace_back(&Display::displaymanufacturerAccessFullAccess, SET, "manufacturerAccessFullAccess");
-    info.emplace_back(&Display::displaymanufacturerData, DEVICEINFO, "manufacturerData");
-    info.emplace_back(&Display::displayfetControl, SET, "fetControl");
-    info.emplace_back(&Display::displaystateOfHealth, STATUSBITS, "stateOfHealth");
-    info.emplace_back(&Display::displaysafetyAlert, DEVICEINFO, "safetyAlert");
-    info.emplace_back(&Display::displaysafetyStatus, STATUSBITS, "safetyStatus");
-    info.emplace_back(&Display::displaypfAlert, DEVICEINFO, "pfAlert");
-    info.emplace_back(&Display::displaypfStatus, STATUSBITS, "pfStatus");
-    info.emplace_back(&Display::displayoperationStatus, DEVICEINFO, "operationStatus");
-    info.emplace_back(&Display::displayunsealKey, DEVICEINFO, "unsealKey");
-}
-
-void Display::displaymanufacturerAccess() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+BQDisplay<BQ>::BQDisplay(uint8_t address, smbtransport* transport): BQ(address, transport) {}
+
+// display functions in the order of the command table (commandtable.cpp), the names are looked up there
+template <class BQ>
+const pdc<BQDisplay<BQ>> BQDisplay<BQ>::functions[COMMANDS] {
+  &BQDisplay<BQ>::displaymanufacturerAccess,
+  &BQDisplay<BQ>::displayremainingCapacityAlarm,
+  &BQDisplay<BQ>::displayremainingTimeAlarm,
+  &BQDisplay<BQ>::displaybatteryMode,
+  &BQDisplay<BQ>::displayatRate,
+  &BQDisplay<BQ>::displayatRateTimeToFull,
+  &BQDisplay<BQ>::displayatRateTimeToEmpty,
+  &BQDisplay<BQ>::displayatRateOK,
+  &BQDisplay<BQ>::displaytemperature,
+  &BQDisplay<BQ>::displayvoltage,
+  &BQDisplay<BQ>::displaycurrent,
+  &BQDisplay<BQ>::displayaverageCurrent,
+  &BQDisplay<BQ>::displaymaxError,
+  &BQDisplay<BQ>::displayrelativeStateOfCharge,
+  &BQDisplay<BQ>::displayabsoluteStateOfCharge,
+  &BQDisplay<BQ>::displayremainingCapacity,
+  &BQDisplay<BQ>::displayfullCapacity,
+  &BQDisplay<BQ>::displayrunTimeToEmpty,
+  &BQDisplay<BQ>::displayavgTimeToEmpty,
+  &BQDisplay<BQ>::displayavgTimeToFull,
+  &BQDisplay<BQ>::displaychargingCurrent,
+  &BQDisplay<BQ>::displaychargingVoltage,
+  &BQDisplay<BQ>::displaybatteryStatus,
+  &BQDisplay<BQ>::displaycycleCount,
+  &BQDisplay<BQ>::displaydesignCapacity,
+  &BQDisplay<BQ>::displaydesignVoltage,
+  &BQDisplay<BQ>::displayspecificationInfo,
+  &BQDisplay<BQ>::displaymanufactureDate,
+  &BQDisplay<BQ>::displayserialNumber,
+  &BQDisplay<BQ>::displaymanufacturerName,
+  &BQDisplay<BQ>::displaydeviceName,
+  &BQDisplay<BQ>::displaydeviceChemistry,
+  &BQDisplay<BQ>::displayoptionalMFGfunctions,
+  &BQDisplay<BQ>::displaymanufacturerAccessType,
+  &BQDisplay<BQ>::displaymanufacturerAccessFirmware,
+  &BQDisplay<BQ>::displaymanufacturerAccessHardware,
+  &BQDisplay<BQ>::displaymanufacturerAccessStatus,
+  &BQDisplay<BQ>::displaymanufacturerAccessChemistryID,
+  &BQDisplay<BQ>::displaymanufacturerAccessShutdown,
+  &BQDisplay<BQ>::displaymanufacturerAccessSleep,
+  &BQDisplay<BQ>::displaymanufacturerAccessSeal,
+  &BQDisplay<BQ>::displaymanufacturerAccessPermanentFailClear,
+  &BQDisplay<BQ>::displaymanufacturerAccessUnseal,
+  &BQDisplay<BQ>::displaymanufacturerAccessFullAccess,
+  &BQDisplay<BQ>::displaymanufacturerData,
+  &BQDisplay<BQ>::displayfetControl,
+  &BQDisplay<BQ>::displaystateOfHealth,
+  &BQDisplay<BQ>::displaysafetyAlert,
+  &BQDisplay<BQ>::displaysafetyStatus,
+  &BQDisplay<BQ>::displaypfAlert,
+  &BQDisplay<BQ>::displaypfStatus,
+  &BQDisplay<BQ>::displayoperationStatus,
+  &BQDisplay<BQ>::displayunsealKey,
+};
+
+template <class BQ>
+void BQDisplay<BQ>::displaymanufacturerAccess() {
   ansi.print("manufacturerAccess (0x00):");
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(manufacturerAccess(), HEX);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayremainingCapacityAlarm() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayremainingCapacityAlarm() {
   ansi.print("remainingCapacityAlarm (0x01):");
   batteryMode(); // We need to get the Battery Mode first to determine output ranges further on
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(remainingCapacityAlarm());
   ansi.print(batterymode.bits.capacity_mode ? " 10mWh" : "mAh");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayremainingTimeAlarm() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayremainingTimeAlarm() {
   ansi.print("remainingTimeAlarm (0x02):");
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(remainingTimeAlarm());
   ansi.print(" minutes");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaybatteryMode() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaybatteryMode() {
   ansi.print("BatteryMode (0x03):"); 
   batteryMode();
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   printBits(batterymode.raw);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
-  ansi.gotoXY(TAB1, y+1);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
+  column(TAB1);
   ansi.print("Internal Charge Controller:");
-  ansi.gotoXY(TAB2, y+1);
+  column(TAB2);
   ansi.println(batterymode.bits.internal_charge_controller ? "Supported" : "Not Supported");
-  ansi.gotoXY(TAB1, y+2);
+  column(TAB1);
   ansi.print("Primary Battery Support:");
-  ansi.gotoXY(TAB2, y+2);
+  column(TAB2);
   ansi.println(batterymode.bits.primary_battery_support ? "Supported" : "Not Supported");
-  ansi.gotoXY(TAB1, y+3);
+  column(TAB1);
   ansi.print("Condition Flag:");
-  ansi.gotoXY(TAB2, y+3);
+  column(TAB2);
   ansi.println(batterymode.bits.condition_flag ? "Cycle Requested" : "Battery OK");
-  ansi.gotoXY(TAB1, y+4);
+  column(TAB1);
   ansi.print("Internal Charge Controller:");
-  ansi.gotoXY(TAB2, y+4);
+  column(TAB2);
   ansi.println(batterymode.bits.charge_controller_enabled ? "Enabled" : "Disabled");
-  ansi.gotoXY(TAB1, y+5);
+  column(TAB1);
   ansi.print("Primary Battery:");
-  ansi.gotoXY(TAB2, y+5);
+  column(TAB2);
   ansi.println(batterymode.bits.primary_battery ? "Operating in primary role" : "Operating in secondary role");
-  ansi.gotoXY(TAB1, y+6);
+  column(TAB1);
   ansi.print("Alarm Mode:");
-  ansi.gotoXY(TAB2, y+6);
+  column(TAB2);
   ansi.println(batterymode.bits.alarm_mode ? "Broadcasts disabled " : "Broadcasts enabled ");
-  ansi.gotoXY(TAB1, y+7);
+  column(TAB1);
   ansi.print("Charger Mode:");
-  ansi.gotoXY(TAB2, y+7);
+  column(TAB2);
   ansi.println(batterymode.bits.charger_mode ? "Broadcasts disabled " : "Broadcasts enabled ");
-  ansi.gotoXY(TAB1, y+8);
+  column(TAB1);
   ansi.print("Capacity Mode:");
-  ansi.gotoXY(TAB2, y+8);
+  column(TAB2);
   ansi.println(batterymode.bits.capacity_mode ? "In 10mW or 10mWh" : "In mA or mAh");
 }
 
-void Display::displayatRate() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayatRate() {
   ansi.print("At Rate (0x04):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  bool mode = capacityMode();
+  column(TAB2);
   ansi.print(atRate());
-  batteryMode();
-  ansi.print(batterymode.bits.capacity_mode ? "x10mW" : "mA");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  ansi.print(mode ? "x10mW" : "mA");
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayatRateTimeToFull() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayatRateTimeToFull() {
   ansi.print("At Rate Time To Full (0x05):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(atRateTimeToFull());
   ansi.print(" minutes");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayatRateTimeToEmpty() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayatRateTimeToEmpty() {
   ansi.print("At Rate Time To Empty (0x06):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(atRateTimeToEmpty());
   ansi.print(" minutes");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayatRateOK() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayatRateOK() {
   ansi.print("At Rate OK (0x07):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(atRateOK() ? "true" : "false");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaytemperature(){
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaytemperature(){
   ansi.print("Temperature (0x08):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(temperature(), 1);
   ansi.print("K, ");
   ansi.print(temperatureC(), 1);
   ansi.print("C, ");
   ansi.print(temperatureF());
-  ansi.println("F.");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  ansi.print("F.");
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayvoltage() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayvoltage() {
   ansi.print("Voltage (0x09):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print((float)voltage()/1000);
   ansi.print("V");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaycurrent() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaycurrent() {
   ansi.print("Current (0x0a):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(current());
   ansi.print("mA");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayaverageCurrent() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayaverageCurrent() {
   ansi.print("Average Current (0x0b):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(averageCurrent());
   ansi.print("mA");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymaxError() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaymaxError() {
   ansi.print("Max Error (0x0c):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(maxError());
   ansi.print("%");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayrelativeStateOfCharge() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayrelativeStateOfCharge() {
   ansi.print("Relative State Of Charge (0x0d):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(relativeStateOfCharge());
   ansi.print("% of Full Capacity");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayabsoluteStateOfCharge() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayabsoluteStateOfCharge() {
   ansi.print("Absolute State Of Charge (0x0e):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(absoluteStateOfCharge());
   ansi.print("% of Full Capacity");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayremainingCapacity() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayremainingCapacity() {
   ansi.print("Remaining Capacity (0x0f):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  bool mode = capacityMode();
+  column(TAB2);
   ansi.print(remainingCapacity());
-  batteryMode();
-  ansi.print(batterymode.bits.capacity_mode ? "x10mWh" : " mAh");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  ansi.print(mode ? "x10mWh" : " mAh");
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayfullCapacity() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayfullCapacity() {
   ansi.print("Full Capacity (0x10):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  bool mode = capacityMode();
+  column(TAB2);
   ansi.print(fullCapacity());
-  batteryMode();
-  ansi.print(batterymode.bits.capacity_mode ? "x10mWh" : " mAh");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  ansi.print(mode ? "x10mWh" : " mAh");
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayrunTimeToEmpty() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayrunTimeToEmpty() {
   ansi.print("Run Time To Empty (0x11):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(runTimeToEmpty());
   ansi.print(" minutes");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayavgTimeToEmpty() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayavgTimeToEmpty() {
   ansi.print("Average Time To Empty (0x12):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(avgTimeToEmpty());
   ansi.print(" minutes");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayavgTimeToFull() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayavgTimeToFull() {
   ansi.print("Average Time To Full (0x13):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(avgTimeToFull());
   ansi.print(" minutes");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaychargingCurrent() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaychargingCurrent() {
   ansi.print("Desired Charging Current (0x14):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(chargingCurrent());
   ansi.print("mA");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaychargingVoltage() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaychargingVoltage() {
   ansi.print("Desired Charging Voltage (0x15):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(chargingVoltage());
   ansi.print("mV");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaybatteryStatus() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaybatteryStatus() {
   ansi.print("Battery Status (0x16):");
-  ansi.readCursorPosition(x, y);
   batteryStatus();
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   printBits(batterystatus.raw);
-  ansi.gotoXY(TAB3, y);
-  ansi.print(I2Ccode[i2ccode]);
-  ansi.gotoXY(TAB1, y+1);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
+  column(TAB1);
   ansi.print("Fully Discharged:");
-  ansi.gotoXY(TAB2, y+1);
-  ansi.print(batterystatus.bits.fully_discharged ? "True" : "False");
-  ansi.gotoXY(TAB1, y+2);
+  column(TAB2);
+  ansi.println(batterystatus.bits.fully_discharged ? "True" : "False");
+  column(TAB1);
   ansi.print("Fully Charged:");
-  ansi.gotoXY(TAB2, y+2);
-  ansi.print(batterystatus.bits.fully_charged ? "True" : "False");
-  ansi.gotoXY(TAB1, y+3);
+  column(TAB2);
+  ansi.println(batterystatus.bits.fully_charged ? "True" : "False");
+  column(TAB1);
   ansi.print("Discharging:");
-  ansi.gotoXY(TAB2, y+3);
-  ansi.print(batterystatus.bits.discharging ? "True" : "False");
-  ansi.gotoXY(TAB1, y+4);
+  column(TAB2);
+  ansi.println(batterystatus.bits.discharging ? "True" : "False");
+  column(TAB1);
   ansi.print("Initialized:");
-  ansi.gotoXY(TAB2, y+4);
-  ansi.print(batterystatus.bits.initialized ? "Calibrated" : "Calibrating");
-  ansi.gotoXY(TAB1, y+5);
+  column(TAB2);
+  ansi.println(batterystatus.bits.initialized ? "Calibrated" : "Calibrating");
+  column(TAB1);
   ansi.print("Remaining Time Alarm:");
-  ansi.gotoXY(TAB2, y+5);
-  ansi.print(batterystatus.bits.rem_time_alarm ? "Set" : "Not set");
-  ansi.gotoXY(TAB1, y+6);
+  column(TAB2);
+  ansi.println(batterystatus.bits.rem_time_alarm ? "Set" : "Not set");
+  column(TAB1);
   ansi.print("Remaining Capacity Alarm:");
-  ansi.gotoXY(TAB2, y+6);
-  ansi.print(batterystatus.bits.rem_capacity_alarm ? "Set" : "Not set");
-  ansi.gotoXY(TAB1, y+7);
+  column(TAB2);
+  ansi.println(batterystatus.bits.rem_capacity_alarm ? "Set" : "Not set");
+  column(TAB1);
   ansi.print("Terminate Discharge Alarm:");
-  ansi.gotoXY(TAB2, y+7);
-  ansi.print(batterystatus.bits.term_discharge_alarm ? "Capacity depleted" : "Discharge not detected");
-  ansi.gotoXY(TAB1, y+8);
+  column(TAB2);
+  ansi.println(batterystatus.bits.term_discharge_alarm ? "Capacity depleted" : "Discharge not detected");
+  column(TAB1);
   ansi.print("Over Temperature Alarm:");
-  ansi.gotoXY(TAB2, y+8);
-  ansi.print(batterystatus.bits.over_temp_alarm ? "Above limit" : "Within acceptable range");
-  ansi.gotoXY(TAB1, y+9);
+  column(TAB2);
+  ansi.println(batterystatus.bits.over_temp_alarm ? "Above limit" : "Within acceptable range");
+  column(TAB1);
   ansi.print("Terminate Charge Alarm:");
-  ansi.gotoXY(TAB2, y+9);
-  ansi.print(batterystatus.bits.term_charge_alarm ? "Suspend charging" : "No charging, alarm cleared");
-  ansi.gotoXY(TAB1, y+10);    
+  column(TAB2);
+  ansi.println(batterystatus.bits.term_charge_alarm ? "Suspend charging" : "No charging, alarm cleared");
+  column(TAB1);
   ansi.print("Over Charged Alarm:");
-  ansi.gotoXY(TAB2, y+10);
+  column(TAB2);
   ansi.println(batterystatus.bits.over_charged_alarm ? "Battery fully charged" : "Cleared");
+  column(TAB1);
+  ansi.print("Error Code:");
+  column(TAB2);
+  ansi.println(sbsErrorCode(batterystatus.bits.error_codes));
 }
 
-void Display::displaycycleCount() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaycycleCount() {
   ansi.print("Cycle Count (0x17):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(cycleCount());
   ansi.print(" times");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaydesignCapacity() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaydesignCapacity() {
   ansi.print("Design Capacity (0x18):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  bool mode = capacityMode();
+  column(TAB2);
   ansi.print(designCapacity());
-  ansi.print(batterymode.bits.capacity_mode ? "x10mWh" : " mAh");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  ansi.print(mode ? "x10mWh" : " mAh");
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaydesignVoltage() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaydesignVoltage() {
   ansi.print("Design Voltage (0x19):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print((float)designVoltage()/1000);
   ansi.print("V");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayspecificationInfo() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayspecificationInfo() {
   ansi.print("Protocol (0x1a):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(specificationInfo());
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymanufactureDate() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaymanufactureDate() {
   ansi.print("Manufacture Date (0x1b): ");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(manufactureDay());
   ansi.print("-");
   ansi.print(manufactureMonth());
   ansi.print("-");
   ansi.print(manufactureYear());
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displayserialNumber() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayserialNumber() {
   ansi.print("Serial Number (0x1c):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(serialNumber());
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymanufacturerName() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaymanufacturerName() {
   ansi.print("Manufacturer Name (0x20):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(manufacturerName());
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaydeviceName() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaydeviceName() {
   ansi.print("Device Name (0x21):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(deviceName());
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaydeviceChemistry() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaydeviceChemistry() {
   ansi.print("Device Chemistry (0x22):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print(deviceChemistry());
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
 // Following functions are not part of the smart battery specification version 1.1
-void Display::displayoptionalMFGfunctions() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayoptionalMFGfunctions() {
   ansi.print("Voltage Cell 1 to 4 (0x3f-0x3c):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print((float)optionalMFGfunction4()/1000);
   ansi.print("V, ");
   ansi.print((float)optionalMFGfunction3()/1000);
@@ -528,353 +476,316 @@ void Display::displayoptionalMFGfunctions() {
   ansi.print((float)optionalMFGfunction2()/1000);
   ansi.print("V, ");
   ansi.print((float)optionalMFGfunction1()/1000);
-  ansi.println("V.");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  ansi.print("V.");
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-// specific BQ20Zxx commands
-void Display::displaymanufacturerAccessType() { // command 0x00 0x0001
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <>
+void BQDisplay<bq20z9xx>::displaymanufacturerAccessType() { // command 0x00 0x0001
   ansi.print("manufacturerAccessType (0x00->0x0001):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print("BQ20Z");
   ansi.print(manufacturerAccessType(), HEX);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymanufacturerAccessFirmware() {   // command 0x00
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <>
+void BQDisplay<bq20z9xx>::displaymanufacturerAccessFirmware() {   // command 0x00
   ansi.print("Firmware version (0x00->0x0002):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   uint16_t version = manufacturerAccessFirmware();
   ansi.print(version >> 8 , DEC);
   ansi.print(".");
   ansi.print((uint8_t)version, DEC);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymanufacturerAccessHardware() {   // command 0x00
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <>
+void BQDisplay<bq20z9xx>::displaymanufacturerAccessHardware() {   // command 0x00
   ansi.print("Hardware version (0x00->0x0003):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print((uint8_t)manufacturerAccessHardware(), HEX);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymanufacturerAccessStatus() {     // command 0x00
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <>
+void BQDisplay<bq20z9xx>::displaymanufacturerAccessStatus() {     // command 0x00
   ansi.print("ManufacturerStatus (0x00->0x0006):");
   manufacturerAccessStatus();
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   printBits(manufacturerstatus.raw);
-  ansi.gotoXY(TAB3, y);
-  ansi.print(I2Ccode[i2ccode]);
-  ansi.gotoXY(TAB1, y+1);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
+  column(TAB1);
   ansi.print("State: ");
-  ansi.gotoXY(TAB2, y+1);
-  ansi.print(statuscodes[manufacturerstatus.bits.state]);
-  if (manufacturerstatus.bits.state == 9) ansi.print(", " + permanentfailurecodes[manufacturerstatus.bits.pf]);
-  ansi.gotoXY(TAB1, y+2);
+  column(TAB2);
+  ansi.print(statusCode(manufacturerstatus.bits.state));
+  if (manufacturerstatus.bits.state == 9) {
+    ansi.print(", ");
+    ansi.print(permanentFailureCode(manufacturerstatus.bits.pf));
+  }
+  ansi.println();
+  column(TAB1);
   ansi.print("FETs:");
-  ansi.gotoXY(TAB2, y+2);
-  ansi.println(fetcodes[manufacturerstatus.bits.fet]);
+  column(TAB2);
+  ansi.println(fetCode(manufacturerstatus.bits.fet));
 }
 
-void Display::displaymanufacturerAccessChemistryID() { // command 0x00 0x0008
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <>
+void BQDisplay<bq20z9xx>::displaymanufacturerAccessChemistryID() { // command 0x00 0x0008
   ansi.print("manufacturerAccessChemistryID (0x00->0x0008):");
   ansi.print(" ");
   ansi.print(manufacturerAccessChemistryID(), HEX);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymanufacturerAccessShutdown(){// command 0x00 0x0010
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaymanufacturerAccessShutdown(){// command 0x00 0x0010
   ansi.print("manufacturerAccessShutdown (0x00->0x0010):");
   manufacturerAccessShutdown();
-  ansi.gotoXY(TAB2, y);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB2);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymanufacturerAccessSleep(){// command 0x00 0x0011
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaymanufacturerAccessSleep(){// command 0x00 0x0011
   ansi.print("manufacturerAccessSleep (0x00->0x0011):");
   manufacturerAccessSleep();
-  ansi.gotoXY(TAB2, y);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB2);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymanufacturerAccessSeal() {       // command 0x00 0x0020
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaymanufacturerAccessSeal() {       // command 0x00 0x0020
   ansi.print("manufacturerAccessSeal (0x00->0x0020):");
   manufacturerAccessSeal();
-  ansi.gotoXY(TAB2, y);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB2);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
   displaySealstatus();
 }
 
-void Display::displaymanufacturerAccessPermanentFailClear(uint16_t key_a, uint16_t key_b){
-  uint16_t x, y; // x and y position
+template <class BQ>
+void BQDisplay<BQ>::displaymanufacturerAccessPermanentFailClear(uint16_t key_a, uint16_t key_b){
   if (displaySealstatus()) ansi.println("Put in Unsealed or Full Access mode first");
   else {
     manufacturerAccessPermanentFailClear(key_a, key_b);
-    ansi.readCursorPosition(x, y);
     ansi.print("manufacturerAccessPermanentFailClear:");
-    ansi.gotoXY(TAB2, y);
+    column(TAB2);
     ansi.print("Keys: a:");
     ansi.print(key_a, HEX);
     ansi.print(", b:");
     ansi.print(key_b, HEX);
-    ansi.gotoXY(TAB3, y);
-    ansi.println(I2Ccode[i2ccode]);
+    column(TAB3);
+    ansi.println(i2cCode(i2ccode));
   }
 }
 
-void Display::displaymanufacturerAccessUnseal(uint16_t key_a, uint16_t key_b){
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaymanufacturerAccessUnseal(uint16_t key_a, uint16_t key_b){
   ansi.print("manufacturerAccessUnseal:");
   manufacturerAccessUnseal(key_a, key_b);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print("Used keys: a:");
   ansi.print(key_a, HEX);
   ansi.print(", b:");
   ansi.print(key_b, HEX);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymanufacturerAccessFullAccess(uint16_t key_a, uint16_t key_b){
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaymanufacturerAccessFullAccess(uint16_t key_a, uint16_t key_b){
   ansi.print("manufacturerAccessFullAccess:");
   manufacturerAccessFullAccess(key_a, key_b);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   ansi.print("Used keys: a:");
   ansi.print(key_a, HEX);
   ansi.print(", b:");
   ansi.print(key_b, HEX);
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
 }
 
-void Display::displaymanufacturerData() {             // command 0x23
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <>
+void BQDisplay<bq20z9xx>::displaymanufacturerData() {             // command 0x23
   ansi.print("ManufacturerData (0x23):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   manufacturerData();
   batteryStatus();
   for (uint8_t i = 0; i < 15; i++) {
     ansi.printf("%02x", manufacturerdata.raw[i]);
   }
-  ansi.println(" " + I2Ccode[i2ccode]);
-  ansi.gotoXY(TAB1, y+1);
+  ansi.print(" ");
+  ansi.println(i2cCode(i2ccode));
+  column(TAB1);
   ansi.print("Pack Lot Code:");
-  ansi.gotoXY(TAB2, y+1);
-  ansi.print(manufacturerdata.bytes.PackLotCode, HEX);
-  ansi.gotoXY(TAB1, y+2);
+  column(TAB2);
+  ansi.println(manufacturerdata.bytes.PackLotCode, HEX);
+  column(TAB1);
   ansi.print("PCB Lot Code:");
-  ansi.gotoXY(TAB2, y+2);
-  ansi.print(manufacturerdata.bytes.PCBLotCode, HEX);
-  ansi.gotoXY(TAB1, y+3);
+  column(TAB2);
+  ansi.println(manufacturerdata.bytes.PCBLotCode, HEX);
+  column(TAB1);
   ansi.print("Firmware Version:");
-  ansi.gotoXY(TAB2, y+3);
-  ansi.print(manufacturerdata.bytes.FirmwareVersion, HEX);
-  ansi.gotoXY(TAB1, y+4);
+  column(TAB2);
+  ansi.println(manufacturerdata.bytes.FirmwareVersion, HEX);
+  column(TAB1);
   ansi.print("Hardware Revision:");
-  ansi.gotoXY(TAB2, y+4);
-  ansi.print(manufacturerdata.bytes.HardwareRevision, HEX);
-  ansi.gotoXY(TAB1, y+5);
+  column(TAB2);
+  ansi.println(manufacturerdata.bytes.HardwareRevision, HEX);
+  column(TAB1);
   ansi.print("Cell Revision:");
-  ansi.gotoXY(TAB2, y+5);
-  ansi.print(manufacturerdata.bytes.CellRevision, HEX);
-  ansi.gotoXY(TAB1, y+6);
+  column(TAB2);
+  ansi.println(manufacturerdata.bytes.CellRevision, HEX);
+  column(TAB1);
   ansi.print("Partial Reset Counter:");
-  ansi.gotoXY(TAB2, y+6);
-  ansi.print(manufacturerdata.bytes.PartialResetCounter, HEX);
-  ansi.gotoXY(TAB1, y+7);
+  column(TAB2);
+  ansi.println(manufacturerdata.bytes.PartialResetCounter, HEX);
+  column(TAB1);
   ansi.print("Full Reset Counter:");
-  ansi.gotoXY(TAB2, y+7);
-  ansi.print(manufacturerdata.bytes.FullResetCounter, HEX);
-  ansi.gotoXY(TAB1, y+8);
+  column(TAB2);
+  ansi.println(manufacturerdata.bytes.FullResetCounter, HEX);
+  column(TAB1);
   ansi.print("Watchdog Reset Counter:");
-  ansi.gotoXY(TAB2, y+8);
-  ansi.print(manufacturerdata.bytes.WatchdogResetCounter, HEX);
-  ansi.gotoXY(TAB1, y+9);
+  column(TAB2);
+  ansi.println(manufacturerdata.bytes.WatchdogResetCounter, HEX);
+  column(TAB1);
   ansi.print("Check Sum:");
-  ansi.gotoXY(TAB2, y+9);
+  column(TAB2);
   ansi.println(manufacturerdata.bytes.CheckSum, HEX);
-  ansi.gotoXY(TAB1, y+10);
+  column(TAB1);
   ansi.print("String Length:");
-  ansi.gotoXY(TAB2, y+10);
+  column(TAB2);
   ansi.println(manufacturerdata.bytes.Length, DEC);
 }
 
-void Display::displayfetControl(){
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayfetControl(){
   ansi.print("FETControl (0x46):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   fetControl();
   if (i2ccode) {
-    ansi.print(I2Ccode[i2ccode]);
+    ansi.print(i2cCode(i2ccode));
     ansi.println(", is device unsealed ?");
   } else { 
     printBits(fetcontrol.raw);
-    ansi.gotoXY(TAB3, y);
-    ansi.println(I2Ccode[i2ccode]);
-    ansi.gotoXY(TAB1, y+1);
+    column(TAB3);
+    ansi.println(i2cCode(i2ccode));
+    column(TAB1);
     ansi.print("Charge FET:");
-    ansi.gotoXY(TAB2, y+1);
+    column(TAB2);
     ansi.println(fetcontrol.bits.chg?"On":"Off");
-    ansi.gotoXY(TAB1, y+2);
+    column(TAB1);
     ansi.print("DisCharge FET:");
-    ansi.gotoXY(TAB2, y+2);
+    column(TAB2);
     ansi.println(fetcontrol.bits.dsg?"On":"Off");
   }
 }
 
-void Display::displaystateOfHealth() {                // command 0x4f
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaystateOfHealth() {                // command 0x4f
   ansi.print("State Of Health (0x4f):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   uint16_t data = stateOfHealth();
   if (i2ccode) {
-    ansi.print(I2Ccode[i2ccode]);
+    ansi.print(i2cCode(i2ccode));
     ansi.println(", is device unsealed ?");
   } else { 
-    ansi.print(data + "%");
-    ansi.gotoXY(TAB3, y);
-    ansi.println(I2Ccode[i2ccode]);
+    ansi.print(data);
+    ansi.print("%");
+    column(TAB3);
+    ansi.println(i2cCode(i2ccode));
   }
 }
 
-void Display::displaysafetyAlert() {                  // command 0x50
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
-  ansi.print("Safety Alert (0x50):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
-  safetyAlert();
-  if (i2ccode) {
-    ansi.print(I2Ccode[i2ccode]);
-    ansi.println(", is device unsealed ?");
-  } else { 
-    printBits(safetyalert.raw);
-    ansi.gotoXY(TAB3, y);
-    ansi.println(I2Ccode[i2ccode]);
+// reads one of the flag registers 0x50 - 0x54 into its union
+template <class BQ>
+uint32_t BQDisplay<BQ>::flags(uint8_t reg) {
+  switch (reg) {
+    case SAFETYALERT:  safetyAlert();  return safetyalert.raw;
+    case SAFETYSTATUS: safetyStatus(); return safetystatus.raw;
+    case PFALERT:      pfAlert();      return pfalert.raw;
+    case PFSTATUS:     pfStatus();     return pfstatus.raw;
+    default:           operationStatus(); return operationstatus.raw;
   }
 }
 
-void Display::displaysafetyStatus() {                 // command 0x51
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
-  ansi.print("Safety Status (0x51):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
-  safetyStatus();
-  if (i2ccode) {
-    ansi.print(I2Ccode[i2ccode]);
-    ansi.println(", is device unsealed ?");
-  } else { 
-    printBits(safetystatus.raw);
-    ansi.gotoXY(TAB3, y);
-    ansi.println(I2Ccode[i2ccode]);
-  }
+// BatteryMode for the unit of a capacity or rate value. It is served from the cache and read before the value, so
+// i2ccode belongs to the value.
+template <class BQ>
+bool BQDisplay<BQ>::capacityMode() {
+  batteryMode();
+  return batterymode.bits.capacity_mode;
 }
 
-void Display::displaypfAlert() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
-  ansi.print("PF Alert (0x52):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
-  pfAlert();
+// the bits of a flag register, followed by the bits which flipped since it was read before
+template <class BQ>
+void BQDisplay<BQ>::displayFlags(const char* label, uint8_t reg) {
+  ansi.print(label);
+  column(TAB2);
+  uint32_t value = flags(reg);
   if (i2ccode) {
-    ansi.print(I2Ccode[i2ccode]);
+    ansi.print(i2cCode(i2ccode));
     ansi.println(", is device unsealed ?");
   } else { 
-    printBits(pfalert.raw);
-    ansi.gotoXY(TAB3, y);
-    ansi.println(I2Ccode[i2ccode]);
+    printBits((decltype(safetyalert.raw))value);
+    column(TAB3);
+    ansi.print(i2cCode(i2ccode));
+    if (flagsChanged(reg)) ansi.printf(", flipped 0x%lx", (unsigned long)flagsChanged(reg));
+    ansi.println();
   }
 }
 
-void Display::displaypfStatus() {
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
-  ansi.print("PF Status (0x53):");
-  ansi.readCursorPosition(x, y);
-  ansi.gotoXY(TAB2, y);
-  pfStatus();
-  if (i2ccode) {
-    ansi.print(I2Ccode[i2ccode]);
-    ansi.println(", is device unsealed ?");
-  } else { 
-    printBits(pfstatus.raw);
-    ansi.gotoXY(TAB3, y);
-    ansi.println(I2Ccode[i2ccode]);
-  }
+template <class BQ>
+void BQDisplay<BQ>::displaysafetyAlert() {                  // command 0x50
+  displayFlags("Safety Alert (0x50):", SAFETYALERT);
 }
 
-void Display::displayoperationStatus() {              // command 0x54
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
-  ansi.print("Operation Status (0x54):");
-  ansi.gotoXY(TAB2, y);
-  operationStatus();
-  if (i2ccode) {
-    ansi.print(I2Ccode[i2ccode]);
-    ansi.println(", is device unsealed ?");
-  } else { 
-    printBits(operationstatus.raw);
-    ansi.gotoXY(TAB3, y);
-    ansi.println(I2Ccode[i2ccode]);
-  }
+template <class BQ>
+void BQDisplay<BQ>::displaysafetyStatus() {                 // command 0x51
+  displayFlags("Safety Status (0x51):", SAFETYSTATUS);
 }
 
-void Display::displayunsealKey(){                     // command 0x60
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displaypfAlert() {
+  displayFlags("PF Alert (0x52):", PFALERT);
+}
+
+template <class BQ>
+void BQDisplay<BQ>::displaypfStatus() {
+  displayFlags("PF Status (0x53):", PFSTATUS);
+}
+
+template <class BQ>
+void BQDisplay<BQ>::displayoperationStatus() {              // command 0x54
+  displayFlags("Operation Status (0x54):", OPERATIONSTATUS);
+}
+
+template <>
+void BQDisplay<bq20z9xx>::displayunsealKey(){                     // command 0x60
   ansi.print("unsealKey (0x60):");
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   uint32_t key = unsealKey();
     if (i2ccode) {
-    ansi.print(I2Ccode[i2ccode]);
+    ansi.print(i2cCode(i2ccode));
     ansi.println(", is device in full access mode ?");
   } else { 
     ansi.print(key, HEX);;
-    ansi.gotoXY(TAB3, y);
-    ansi.println(I2Ccode[i2ccode]);
+    column(TAB3);
+    ansi.println(i2cCode(i2ccode));
   }
 }
 
-bool Display::testkey(uint16_t key) {
+template <class BQ>
+bool BQDisplay<BQ>::testkey(uint16_t key) {
     writeRegister(MANUFACTURERACCESS, key);
 /*  switch (com) {
     case 1:
@@ -896,82 +807,186 @@ bool Display::testkey(uint16_t key) {
 }
 
 // returns true if sealed, false otherwise
-bool Display::displaySealstatus() {
+template <>
+bool BQDisplay<bq20z9xx>::displaySealstatus() {
   bool status {true};
-  uint16_t x, y; // x and y position
-  ansi.readCursorPosition(x, y);
   operationStatus();
-  ansi.gotoXY(TAB1, y);
+  column(TAB1);
   ansi.print("Mode: ");
-  ansi.gotoXY(TAB2, y);
+  column(TAB2);
   if(!i2ccode) {
     status = false;
     ansi.print(operationstatus.bits.ss?"":"Unsealed");
     ansi.print(operationstatus.bits.fas?"":" Full access");
-    ansi.println();
-  } else ansi.println("Sealed");
-  ansi.gotoXY(TAB3, y);
-  ansi.println(I2Ccode[i2ccode]);
+  } else ansi.print("Sealed");
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
   return status;
 }
 
-void Display::displayBatteryAddress() {
-    uint16_t x, y; // x and y position
-    ansi.readCursorPosition(x, y);
+template <class BQ>
+void BQDisplay<BQ>::displayBatteryAddress() {
     ansi.print("Batteryaddress set to: ");
-    ansi.gotoXY(TAB2, y);
+    column(TAB2);
     ansi.print("0x");
     ansi.print(address() < 0x10 ? "0": "");
     ansi.println(address(), HEX);
+    ansi.print("Chip:");
+    column(TAB2);
+    ansi.println(bqChipName(chip()));
 }
 
 // Helper to simulate remove_cvref_t
 template <typename T>
 using remove_cvref_t = typename std::remove_cv<typename std::remove_reference<T>::type>::type;
 
-// Call a specific function by name
-void Display::displayByName(const String& functionName) {
-  
-  auto it = std::find_if(info.begin(), info.end(), [&functionName](const Info<Display>& entry) {return entry.name == functionName;});
-  if (it != info.end()) {
-    std::visit([this](auto& f) {
-      using FunctionType = remove_cvref_t<decltype(f)>;
-      // Handle different member function signatures
-      if constexpr (std::is_same_v<FunctionType, void (Display::*)()>) { 
-          (this->*f)();
-      } else if constexpr (std::is_same_v<FunctionType, void (Display::*)(uint16_t, uint16_t)>) {
-          (this->*f)(0, 0); // Provide default arguments
-      } else { Serial.println("Unsupported function type."); }
-    }, it->dc);
+// calls the display function of a command table entry
+template <class BQ>
+void BQDisplay<BQ>::call(uint8_t index) {
+  std::visit([this](auto& f) {
+    using FunctionType = remove_cvref_t<decltype(f)>;
+    // Handle different member function signatures
+    if constexpr (std::is_same_v<FunctionType, void (BQDisplay::*)()>) {
+        (this->*f)();
+    } else if constexpr (std::is_same_v<FunctionType, void (BQDisplay::*)(uint16_t, uint16_t)>) {
+        (this->*f)(0, 0); // Provide default arguments
+    } else { ansi.println("Unsupported function type."); }
+  }, functions[index]);
+}
+
+// Call a specific function by name, the name is case-insensitive and may be shortened to a unique prefix
+template <class BQ>
+void BQDisplay<BQ>::displayByName(const String& functionName) {
+  uint8_t index = commandFind(functionName.c_str());
+  uint8_t first = 0;
+  uint8_t matches = index == NOCOMMAND ? commandPrefix(functionName.c_str(), first) : 0;
+  if (matches == 1) index = commandSorted(first);
+  if (index != NOCOMMAND) {
+    displayByIndex(index);
+  } else if (matches > 1) {
+    ansi.print("Function \"");
+    ansi.print(functionName);
+    ansi.println("\" is ambiguous:");
+    for (uint8_t position = first; position < first + matches; position++) ansi.println(commandName(commandSorted(position)));
+  } else {
+    ansi.print("Function \"");
+    ansi.print(functionName);
+    ansi.println("\" not found.");
+  }
+}
+
+// Call one function of the command table, as text or as record depending on the output
+template <class BQ>
+void BQDisplay<BQ>::displayByIndex(uint8_t index) {
+  if (index >= COMMANDS) return;
+  if (output == OUTPUTBINARY) {
+    telemetry.begin(TELEMETRYREGISTER, address(), millis(), 0);
+    record(index);
+    sendTelemetry();
+  } else if (output != OUTPUTTEXT) {
+    record(index);
   } else {
-    Serial.print("Function \"" + functionName + "\" not found.\n");
+    call(index);
   }
 }
 
 // Call all functions with the same classifier
-void Display::displayByClassifier(uint8_t type) {
+template <class BQ>
+void BQDisplay<BQ>::displayByClassifier(uint8_t type) {
   if (type > 5) return;
-  for (const auto& it : info) {
-    if (it.monitor_group == type) {
-      std::visit([this](auto& f) {
-        using FunctionType = remove_cvref_t<decltype(f)>;
-        // Handle different member function signatures
-        if constexpr (std::is_same_v<FunctionType, void (Display::*)()>) {
-            (this->*f)();
-        } else if constexpr (std::is_same_v<FunctionType, void (Display::*)(uint16_t, uint16_t)>) {
-            (this->*f)(0, 0); // Provide default arguments
-        } else { Serial.println("Unsupported function type."); }
-      }, it.dc);
-    }
+  if (output == OUTPUTBINARY) telemetry.begin(TELEMETRYREGISTER, address(), millis(), 0); // one frame for the category
+  for (uint8_t index = 0; index < COMMANDS; index++) {
+    if (commandGroup(index) != type) continue;
+    if (output == OUTPUTTEXT) call(index);
+    else if (commandRegister(index) != NOREGISTER || commandFlags(index) != NOREGISTER) record(index);
   }
+  if (output == OUTPUTBINARY) sendTelemetry();
 }
 
-void Display::displayCommandNames(){
-    for (const auto& it : info) {
-      Serial.println(it.name); 
+template <class BQ>
+void BQDisplay<BQ>::displayCommandNames(){
+    for (uint8_t index = 0; index < COMMANDS; index++) {
+      ansi.println(commandName(index));
     }
 }
 
+// prints the register of a display function as CSV or NDJSON record, see records.h. Binary adds it to the open frame.
+template <class BQ>
+void BQDisplay<BQ>::record(uint8_t index) {
+  uint8_t reg = commandRegister(index);
+  if (output == OUTPUTBINARY) {
+    if (reg == NOREGISTER || sbsDescriptor(reg).width != 2) return; // frames carry words only
+    uint16_t raw = readRegister(reg);
+    telemetry.add(reg, raw, i2ccode);
+    return;
+  }
+  char name[COMMANDNAMESIZE];
+  commandName(index, name);
+  uint8_t flag = commandFlags(index);
+  if (flag != NOREGISTER) {
+    uint32_t value = flags(flag);
+    recordFlags(ansi, output, address(), flag, name, value, flagsChanged(flag), i2ccode);
+    return;
+  }
+  if (reg == NOREGISTER) {
+    recordError(ansi, output, name, "no register");
+    return;
+  }
+  if (sbsDescriptor(reg).unit == UNITTEXT) {
+    const char* text = reg == MANUFACTURERNAME ? manufacturerName() : reg == DEVICENAME ? deviceName() : deviceChemistry();
+    recordText(ansi, output, address(), reg, name, text, i2ccode);
+    return;
+  }
+  bool mode = capacityMode();
+  uint16_t raw = readRegister(reg);
+  recordWord(ansi, output, address(), reg, name, raw, mode, i2ccode);
+}
+
+// reads all word registers in one frame and prints them as one record, or one line per register as text
+template <class BQ>
+void BQDisplay<BQ>::displaySnapshot() {
+  smbsnapshot frame;
+  readSnapshot(frame);
+  if (output == OUTPUTBINARY) {
+    uint8_t data[TELEMETRYFRAME];
+    ansi.write(data, telemetry.encode(frame, data));
+    return;
+  }
+  if (output != OUTPUTTEXT) {
+    recordSnapshot(ansi, output, frame);
+    return;
+  }
+  ansi.print("Snapshot of 0x");
+  ansi.print(frame.address, HEX);
+  ansi.print(" in ");
+  ansi.print(frame.duration);
+  ansi.println("us:");
+  for (uint8_t reg = 0; reg < SNAPSHOTREGISTERS; reg++) {
+    if (!frame.isValid(reg) && frame.code[reg] == 0) continue;
+    column(TAB1);
+    ansi.printf("0x%02x", reg);
+    column(TAB2);
+    if (frame.isValid(reg)) ansi.print(frame.word[reg]);
+    column(TAB3);
+    ansi.println(i2cCode(frame.code[reg]));
+  }
+}
+
+uint8_t Display::output {OUTPUTTEXT};
+telemetryencoder Display::telemetry;
+
+// ends the open telemetry frame and writes it
+void Display::sendTelemetry() {
+  uint8_t data[TELEMETRYFRAME];
+  ansi.write(data, telemetry.end(data));
+}
+
+// moves the cursor to column x of the current line, without asking the terminal where the cursor is
+void Display::column(uint8_t x) {
+  ansi.print('\r');
+  if (x > 1) ansi.cursorForward(x - 1);
+}
+
 // prints 8-bit integer in this form: 0000 0000
 void Display::printBits(uint8_t n) {
   byte numBits = 8;  // 2^numBits must be big enough to include the number n
@@ -997,3 +1012,143 @@ void Display::printBits(uint16_t n) {
     if (i < (numBits - 1) && ((numBits-i - 1) % 4 == 0 )) ansi.print(c); // print a separator at every 4 bits
   }
 }
+
+// prints 32-bit integer in this form: 0000 0000 0000 0000 0000 0000 0000 0000
+void Display::printBits(uint32_t n) {
+  printBits((uint16_t)(n >> 16));
+  ansi.print(' ');
+  printBits((uint16_t)n);
+}
+
+template <>
+uint8_t BQDisplay<bq20z9xx>::chip() {
+  return BQTYPE20Z9XX;
+}
+
+// specific BQ40Z6xx commands, the ManufacturerAccess results are read as a block via ManufacturerBlockAccess (0x44)
+template <>
+uint8_t BQDisplay<bq40z6xx>::chip() {
+  return BQTYPE40Z6XX;
+}
+
+template <>
+void BQDisplay<bq40z6xx>::displaymanufacturerAccessType() { // command 0x00 0x0001
+  ansi.print("manufacturerAccessType (0x00->0x0001):");
+  column(TAB2);
+  char* data = manufacturerAccessType();
+  ansi.print("BQ");
+  ansi.print((uint8_t)data[1] << 8 | (uint8_t)data[0], HEX);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
+}
+
+template <>
+void BQDisplay<bq40z6xx>::displaymanufacturerAccessFirmware() {   // command 0x00 0x0002
+  ansi.print("Firmware version (0x00->0x0002):");
+  column(TAB2);
+  char* data = manufacturerAccessFirmware();
+  ansi.print((uint8_t)data[3], HEX);
+  ansi.print(".");
+  ansi.printf("%02x", (uint8_t)data[2]);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
+}
+
+template <>
+void BQDisplay<bq40z6xx>::displaymanufacturerAccessHardware() {   // command 0x00 0x0003
+  ansi.print("Hardware version (0x00->0x0003):");
+  column(TAB2);
+  char* data = manufacturerAccessHardware();
+  ansi.print((uint8_t)data[1] << 8 | (uint8_t)data[0], HEX);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
+}
+
+template <>
+void BQDisplay<bq40z6xx>::displaymanufacturerAccessStatus() {
+  ansi.print("ManufacturerStatus:");
+  column(TAB2);
+  ansi.println("not available, see operationStatus");
+}
+
+template <>
+void BQDisplay<bq40z6xx>::displaymanufacturerAccessChemistryID() { // command 0x00 0x0006
+  ansi.print("manufacturerAccessChemistryID (0x00->0x0006):");
+  column(TAB2);
+  char* data = manufacturerAccessChemistryID();
+  ansi.print((uint8_t)data[1] << 8 | (uint8_t)data[0], HEX);
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
+}
+
+template <>
+void BQDisplay<bq40z6xx>::displaymanufacturerData() {             // command 0x23
+  ansi.print("ManufacturerData (0x23):");
+  column(TAB2);
+  manufacturerData();
+  for (uint8_t i = 0; i < 16; i++) {
+    ansi.printf("%02x", (uint8_t)manufacturerdata.raw[i]);
+  }
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
+}
+
+template <>
+void BQDisplay<bq40z6xx>::displayunsealKey(){                     // command 0x00 0x0035
+  ansi.print("securityKeys (0x00->0x0035):");
+  column(TAB2);
+  char* data = manufacturerSecurityKeys();
+  if (i2ccode) {
+    ansi.print(i2cCode(i2ccode));
+    ansi.println(", is device in full access mode ?");
+  } else {
+    ansi.printf("unseal %04x%04x, full access %04x%04x",
+      (uint8_t)data[1] << 8 | (uint8_t)data[0], (uint8_t)data[3] << 8 | (uint8_t)data[2],
+      (uint8_t)data[5] << 8 | (uint8_t)data[4], (uint8_t)data[7] << 8 | (uint8_t)data[6]);
+    column(TAB3);
+    ansi.println(i2cCode(i2ccode));
+  }
+}
+
+// returns true if sealed, false otherwise. OperationStatus[SEC1,SEC0]: 3 sealed, 2 unsealed, 1 full access
+template <>
+bool BQDisplay<bq40z6xx>::displaySealstatus() {
+  bool status {true};
+  operationStatus();
+  column(TAB1);
+  ansi.print("Mode: ");
+  column(TAB2);
+  if (!i2ccode) {
+    status = operationstatus.bits.sec == 3;
+    ansi.print(operationstatus.bits.sec == 3 ? "Sealed" : operationstatus.bits.sec == 2 ? "Unsealed" : "Full access");
+  } else ansi.print("Sealed");
+  column(TAB3);
+  ansi.println(i2cCode(i2ccode));
+  return status;
+}
+
+/**
+ * @brief Detects the chip at the address and builds its display in place of the previous one.
+ * An unknown chip gets the bq20z9xx functions, as before the detection existed.
+ * @param address
+ * @param transport nullptr for the default transport
+ * @return Display* valid until the next open() or close()
+ */
+Display* batterysession::open(uint8_t address, smbtransport* transport) {
+  switch (bqDetect(address, transport)) {
+    case BQTYPE40Z6XX:
+      active = &storage.emplace<BQDisplay<bq40z6xx>>(address, transport);
+      break;
+    default:
+      active = &storage.emplace<BQDisplay<bq20z9xx>>(address, transport);
+  }
+  return active;
+}
+
+void batterysession::close() {
+  storage.emplace<std::monostate>();
+  active = nullptr;
+}
+
+template class BQDisplay<bq20z9xx>;
+template class BQDisplay<bq40z6xx>;
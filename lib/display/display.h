@@ -7,10 +7,13 @@
 #include <Arduino.h>
 #include "../ansi/ansi.h"
 #include "../BQ/BQ20Z9xx.h"
+#include "../BQ/BQ40Z6xx.h"
 #include "../i2cscanner/i2cscanner.h"
 #include "CommandClassifiers.h"
+#include "records.h"
+#include "commandtable.h"
+#include "../telemetry/telemetry.h"
 #include <variant>
-#include <vector>
 
 extern ANSI ansi;
 
@@ -20,19 +23,63 @@ using pdc = std::variant<             // pdc = pointer to display command
     void (T::*)(uint16_t, uint16_t)  // Member function with signature `bool(uint16_t, uint16_t)
 >;
 
-template <typename T>
-struct Info {
-  pdc<T> dc;                          // dc = display command
-  uint8_t monitor_group;
-  String name;                        // name of the battery function the display function calls 
-  // Constructor to initialize the struct
-  Info(pdc<T> f, uint8_t g, String n) : dc(f), monitor_group(g), name(n) {};
+/**
+ * @class Display
+ * @brief Interface of the display functions used by the command states. The implementation depends on the chip found
+ * at the address, batterysession::open() detects it and builds the matching BQDisplay.
+ */
+class Display {
+
+public:
+    virtual ~Display() {};
+    virtual uint8_t address() = 0;
+    virtual uint8_t chip() = 0;
+    virtual void setPec(bool) = 0;
+    virtual uint16_t pecErrors(uint8_t) = 0;
+
+    virtual void displayBatteryAddress() = 0;
+    virtual void displaymanufacturerAccessSeal() = 0;
+    virtual void displaymanufacturerAccessPermanentFailClear(uint16_t key_a = PFCLEARA, uint16_t key_b = PFCLEARB) = 0;
+    virtual void displaymanufacturerAccessUnseal(uint16_t key_a = UNSEALA, uint16_t key_b = UNSEALB) = 0;
+    virtual void displaymanufacturerAccessFullAccess(uint16_t key_a = FULLACCESSA, uint16_t key_b = FULLACCESSB) = 0;
+    virtual bool testkey(uint16_t) = 0;  // Tests a 16 bit key part. Returns true if I2C code is ok.
+
+    // Call a specific function by name
+    virtual void displayByName(const String&) = 0;
+    virtual void displayByIndex(uint8_t) = 0;   // index in the command table
+    // Call functions dynamically
+    virtual void displayByClassifier(uint8_t) = 0;
+    virtual void displayCommandNames() = 0;
+    virtual void displaySnapshot() = 0;
+
+    // Output format of displayByName, displayByClassifier and displaySnapshot, shared by all batteries
+    static void setOutput(uint8_t format) { output = format; };
+    static uint8_t getOutput() { return output; };
+
+protected:
+    void sendTelemetry();
+    static uint8_t output;      // OUTPUTTEXT, OUTPUTCSV, OUTPUTJSON or OUTPUTBINARY
+    static telemetryencoder telemetry; // one sequence number for all frames
+    void column(uint8_t);
+    void printBits(uint8_t);
+    void printBits(uint16_t);
+    void printBits(uint32_t);
 };
 
-class Display : private bq20z9xx {
+/**
+ * @class BQDisplay
+ * @brief Display functions for one chip family. The chip specific functions (ManufacturerAccess sub-commands, seal
+ * state, unseal key) are specialized in display.cpp, the others are shared.
+ */
+template <class BQ>
+class BQDisplay : public Display, private BQ {
 
 public:
-    Display(uint8_t);
+    BQDisplay(uint8_t, smbtransport* transport = nullptr);
+    uint8_t address() override { return BQ::address(); };
+    uint8_t chip() override;
+    void setPec(bool enable) override { BQ::setPec(enable); };
+    uint16_t pecErrors(uint8_t reg) override { return BQ::pecErrors(reg); };
     void displaymanufacturerAccess();
     void displayremainingCapacityAlarm();
     void displayremainingTimeAlarm();
@@ -74,10 +121,10 @@ public:
     void displaymanufacturerAccessChemistryID(); // command 0x00 0x0008
     void displaymanufacturerAccessShutdown();   // command 0x0010
     void displaymanufacturerAccessSleep();      // command 0x0011
-    void displaymanufacturerAccessSeal();       // command 0x00 0x0020
-    void displaymanufacturerAccessPermanentFailClear(uint16_t key_a = PFCLEARA, uint16_t key_b = PFCLEARB); 
-    void displaymanufacturerAccessUnseal(uint16_t key_a = UNSEALA, uint16_t key_b = UNSEALB);
-    void displaymanufacturerAccessFullAccess(uint16_t key_a = FULLACCESSA, uint16_t key_b = FULLACCESSB);
+    void displaymanufacturerAccessSeal() override; // command 0x00 0x0020
+    void displaymanufacturerAccessPermanentFailClear(uint16_t key_a, uint16_t key_b) override;
+    void displaymanufacturerAccessUnseal(uint16_t key_a, uint16_t key_b) override;
+    void displaymanufacturerAccessFullAccess(uint16_t key_a, uint16_t key_b) override;
     void displaymanufacturerData();             // command 0x23
     void displayfetControl();
     void displaystateOfHealth();                // command 0x4f
@@ -87,27 +134,109 @@ public:
     void displaypfStatus();
     void displayoperationStatus();              // command 0x54
     void displayunsealKey();                    // command 0x60
-    void displayBatteryAddress();
+    void displayBatteryAddress() override;
+
 
     bool displaySealstatus();                   // true if sealed, otherwise false.
-    bool testkey(uint16_t);  // Tests a 16 bit key part. Returns true if I2C code is ok.
-    
-    std::vector<Info<Display>> info; // Store structs
+    bool testkey(uint16_t) override;
 
-    // Call a specific function by name
-    void displayByName(const String&);
-    // Call functions dynamically
-    void displayByClassifier(uint8_t);
-    void displayCommandNames();
+    static const pdc<BQDisplay> functions[COMMANDS]; // display functions in the order of the command table
+
+    void displayByName(const String&) override;
+    void displayByIndex(uint8_t) override;
+    void displayByClassifier(uint8_t) override;
+    void displayCommandNames() override;
+    void displaySnapshot() override;
 
 private:
-    void printBits(uint8_t);
-    void printBits(uint16_t);
+    void call(uint8_t index);
+    void record(uint8_t index);
+    uint32_t flags(uint8_t reg);
+    void displayFlags(const char* label, uint8_t reg);
+    bool capacityMode();
+
+    // battery functions used by the shared display functions
+    using BQ::absoluteStateOfCharge;
+    using BQ::atRate;
+    using BQ::atRateOK;
+    using BQ::atRateTimeToEmpty;
+    using BQ::atRateTimeToFull;
+    using BQ::averageCurrent;
+    using BQ::avgTimeToEmpty;
+    using BQ::avgTimeToFull;
+    using BQ::batteryMode;
+    using BQ::batteryStatus;
+    using BQ::chargingCurrent;
+    using BQ::chargingVoltage;
+    using BQ::current;
+    using BQ::cycleCount;
+    using BQ::designCapacity;
+    using BQ::designVoltage;
+    using BQ::deviceChemistry;
+    using BQ::deviceName;
+    using BQ::fetControl;
+    using BQ::flagsChanged;
+    using BQ::fullCapacity;
+    using BQ::manufactureDay;
+    using BQ::manufactureMonth;
+    using BQ::manufactureYear;
+    using BQ::manufacturerAccess;
+    using BQ::manufacturerAccessFullAccess;
+    using BQ::manufacturerAccessPermanentFailClear;
+    using BQ::manufacturerAccessSeal;
+    using BQ::manufacturerAccessShutdown;
+    using BQ::manufacturerAccessSleep;
+    using BQ::manufacturerAccessUnseal;
+    using BQ::manufacturerName;
+    using BQ::maxError;
+    using BQ::operationStatus;
+    using BQ::optionalMFGfunction1;
+    using BQ::optionalMFGfunction2;
+    using BQ::optionalMFGfunction3;
+    using BQ::optionalMFGfunction4;
+    using BQ::pfAlert;
+    using BQ::pfStatus;
+    using BQ::relativeStateOfCharge;
+    using BQ::remainingCapacity;
+    using BQ::remainingCapacityAlarm;
+    using BQ::remainingTimeAlarm;
+    using BQ::runTimeToEmpty;
+    using BQ::safetyAlert;
+    using BQ::safetyStatus;
+    using BQ::serialNumber;
+    using BQ::specificationInfo;
+    using BQ::stateOfHealth;
+    using BQ::temperature;
+    using BQ::temperatureC;
+    using BQ::temperatureF;
+    using BQ::voltage;
+    using BQ::writeRegister;
+    using BQ::readRegister;
+    using BQ::readSnapshot;
+    using BQ::i2ccode;
+    using BQ::batterymode;
+    using BQ::batterystatus;
+    using BQ::manufacturerdata;
+    using BQ::fetcontrol;
+    using BQ::safetyalert;
+    using BQ::safetystatus;
+    using BQ::pfalert;
+    using BQ::pfstatus;
+    using BQ::operationstatus;
 };
 
+/**
+ * @class batterysession
+ * @brief Owner of the display of the selected battery. The BQDisplay of the detected chip is built in place, a new
+ * scan replaces it without using the heap.
+ */
+class batterysession {
+public:
+    Display* open(uint8_t, smbtransport* transport = nullptr);
+    void close();
+    Display* display() { return active; };
 
-
-
-
-
-
+private:
+    std::variant<std::monostate, BQDisplay<bq20z9xx>, BQDisplay<bq40z6xx>> storage;
+    Display* active {nullptr};
+};
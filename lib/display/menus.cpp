@@ -10,11 +10,19 @@ void displayMainmenu() {
     ansi.println("6 = Seal Battery,           ");
     ansi.println("7 = Clear Permanent Failure Use 7 a b, a,b decimal or hex : f.e. 5 0x1234 0x5678. None for default values.");
     ansi.println("8 = Full Access             Use 8 a b, a,b decimal or hex : f.e. 5 0x1234 0x5678. None for default values.");
+    ansi.println("9 = Poll all batteries      Samples every responding address round-robin, use 9 x x for start and end address.");
+    ansi.println("10 = Output                 Use 10 text, 10 csv, 10 json or 10 bin for the output of 3 and 4. 10 s n streams n snapshots.");
+    ansi.println("11 = Schedule               Use 11 c x ms (category), 11 n name ms, 11 s ms (snapshot) to repeat, 11 d id, 11 x, 11 lists.");
+    ansi.println("12 = Log                    Use 12 start ms to log to flash, 12 stop, 12 d to dump, 12 x to erase, 12 for the state.");
+    ansi.println("13 = History                Use 13 start ms to keep min/avg/max in RAM, 13 name s for the last s seconds, 13 stop, 13 for the table.");
+    ansi.println("14 = Capture                Use 14 arm name [ms] [mask] to capture around a status bit change, 14 d to download, 14 x, 14 for the state.");
+    ansi.println("15 = Record                 Use 15 start to record every bus transaction to flash, 15 stop, 15 d to download, 15 for the state.");
+    ansi.println("16 = Data flash             Use 16 d to dump the data flash of a bq20z9xx, 16 r to restore it, 16 u to upload, 16 x to download, 16 for the state.");
 
 }
 
 void displaySmallmenu() {
     ansi.clearScreen();
-    ansi.println("1=Menu, 2=Search, 3=Category, 4=Name, 5=Unseal, 6=Seal, 7=Clear PF, 8=Full Access");
+    ansi.println("1=Menu, 2=Search, 3=Category, 4=Name, 5=Unseal, 6=Seal, 7=Clear PF, 8=Full Access, 9=Poll all, 10=Output, 11=Schedule, 12=Log, 13=History, 14=Capture, 15=Record, 16=Flash");
     ansi.println();
 }
@@ -0,0 +1,218 @@
+/**
+ * @file records.cpp
+ * @author
+ * @brief Function definitions for the CSV and NDJSON records.
+ * Register record, CSV:   r,<millis>,<address>,<register>,<name>,<raw>,<unit>,<i2c code>
+ *                  JSON:  {"t":<millis>,"addr":<address>,"reg":<register>,"name":"<name>","raw":<raw>,"unit":"<unit>","i2c":<code>}
+ * Flag record, CSV:      f,<millis>,<address>,<register>,<name>,<flags>,<bits flipped since the read before>,<i2c code>
+ *                  JSON:  {"t":<millis>,"addr":<address>,"reg":<register>,"name":"<name>","bits":<flags>,"flipped":<bits>,"i2c":<code>}
+ * Snapshot record, CSV:  s,<millis>,<address>,<read time us>,<register>:<raw>,...   a failed register is <register>:!<code>
+ *                  JSON:  {"t":<millis>,"addr":<address>,"us":<read time>,"words":{"<register>":<raw>,...},"i2c":{"<register>":<code>,...}}
+ * Log record, CSV:       l,<millis>,<address>,<mV>,<mA>,<0.1K>,<%>     a sample which could not be read is l,<millis>,<address>,!
+ *                  JSON:  {"t":<millis>,"addr":<address>,"mV":<mV>,"mA":<mA>,"dK":<0.1K>,"soc":<%>}   without values "ok":false
+ * Rollup record, CSV:    h,<millis>,<address>,<register>,<window ms>,<samples>,<min>,<avg>,<max>
+ *                  JSON:  {"t":<millis>,"addr":<address>,"reg":<register>,"ms":<window>,"n":<samples>,"min":<min>,"avg":<avg>,"max":<max>}
+ * Capture record, CSV:   c,<millis>,<address>,<mV>,<mA>,<0.1K>,<register>,<watched>,<1 for the trigger sample, else 0>
+ *                  JSON:  {"t":<millis>,"addr":<address>,"mV":<mV>,"mA":<mA>,"dK":<0.1K>,"reg":<register>,"bits":<watched>,"trig":<1 or 0>}
+ * Numbers are decimal, raw is the register value as read (signed for signed registers), the unit is the unit of raw.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "records.h"
+
+static const char* formatnames[4] {"text", "csv", "json", "bin"};
+
+const char* outputName(uint8_t format) {
+  return format <= OUTPUTBINARY ? formatnames[format] : "";
+}
+
+/**
+ * @brief Unit of the raw value of a register.
+ * @param reg
+ * @param capacitymode BatteryMode capacity_mode, rates and capacities are in 10mW and 10mWh when set
+ * @return const char*
+ */
+const char* recordUnit(uint8_t reg, bool capacitymode) {
+  switch (sbsDescriptor(reg).unit) {
+    case UNITMV:       return "mV";
+    case UNITRATE:     return capacitymode ? "10mW" : "mA";
+    case UNITCAPACITY: return capacitymode ? "10mWh" : "mAh";
+    case UNITDK:       return "0.1K";
+    case UNITPERCENT:  return "%";
+    case UNITMINUTES:  return "min";
+    case UNITDATE:     return "date";
+    default:           return "";
+  }
+}
+
+// prints a string as JSON string, with quotes and escapes
+static void jsonString(Print& out, const char* text) {
+  out.print('"');
+  for (; *text; text++) {
+    if (*text == '"' || *text == '\\') out.print('\\');
+    if ((uint8_t)*text < 0x20) out.printf("\\u%04x", (uint8_t)*text);
+    else out.print(*text);
+  }
+  out.print('"');
+}
+
+/**
+ * @brief Prints the record of a word register.
+ * @param out
+ * @param format OUTPUTCSV or OUTPUTJSON
+ * @param address of the battery
+ * @param reg
+ * @param name of the display function
+ * @param raw value read
+ * @param capacitymode BatteryMode capacity_mode
+ * @param code i2c code of the read
+ */
+void recordWord(Print& out, uint8_t format, uint8_t address, uint8_t reg, const char* name, uint16_t raw, bool capacitymode, uint8_t code) {
+  int32_t value = sbsDescriptor(reg).issigned ? (int32_t)(int16_t)raw : (int32_t)raw;
+  if (format == OUTPUTCSV) {
+    out.printf("r,%lu,%u,%u,%s,%ld,%s,%u\n", (unsigned long)millis(), address, reg, name, (long)value,
+               recordUnit(reg, capacitymode), code);
+  } else {
+    out.printf("{\"t\":%lu,\"addr\":%u,\"reg\":%u,\"name\":", (unsigned long)millis(), address, reg);
+    jsonString(out, name);
+    out.printf(",\"raw\":%ld,\"unit\":\"%s\",\"i2c\":%u}\n", (long)value, recordUnit(reg, capacitymode), code);
+  }
+}
+
+/**
+ * @brief Prints the record of a block register with a string, the string is in the raw field.
+ */
+void recordText(Print& out, uint8_t format, uint8_t address, uint8_t reg, const char* name, const char* text, uint8_t code) {
+  if (format == OUTPUTCSV) {
+    out.printf("r,%lu,%u,%u,%s,", (unsigned long)millis(), address, reg, name);
+    for (const char* c = text; *c; c++) out.print(*c == ',' || *c == '\n' ? ' ' : *c);
+    out.printf(",,%u\n", code);
+  } else {
+    out.printf("{\"t\":%lu,\"addr\":%u,\"reg\":%u,\"name\":", (unsigned long)millis(), address, reg);
+    jsonString(out, name);
+    out.print(",\"raw\":");
+    jsonString(out, text);
+    out.printf(",\"unit\":\"\",\"i2c\":%u}\n", code);
+  }
+}
+
+/**
+ * @brief Prints the record of a flag register (0x50 - 0x54), with the bits which flipped since it was read before.
+ */
+void recordFlags(Print& out, uint8_t format, uint8_t address, uint8_t reg, const char* name, uint32_t flags, uint32_t flipped, uint8_t code) {
+  if (format == OUTPUTCSV) {
+    out.printf("f,%lu,%u,%u,%s,%lu,%lu,%u\n", (unsigned long)millis(), address, reg, name, (unsigned long)flags, (unsigned long)flipped, code);
+  } else {
+    out.printf("{\"t\":%lu,\"addr\":%u,\"reg\":%u,\"name\":", (unsigned long)millis(), address, reg);
+    jsonString(out, name);
+    out.printf(",\"bits\":%lu,\"flipped\":%lu,\"i2c\":%u}\n", (unsigned long)flags, (unsigned long)flipped, code);
+  }
+}
+
+/**
+ * @brief Prints a record telling a function has no machine readable output.
+ */
+void recordError(Print& out, uint8_t format, const char* name, const char* error) {
+  if (format == OUTPUTCSV) out.printf("e,%lu,%s,%s\n", (unsigned long)millis(), name, error);
+  else {
+    out.printf("{\"t\":%lu,\"name\":", (unsigned long)millis());
+    jsonString(out, name);
+    out.print(",\"error\":");
+    jsonString(out, error);
+    out.println('}');
+  }
+}
+
+/**
+ * @brief Prints a snapshot as one record, the registers in increasing order.
+ * @param out
+ * @param format OUTPUTCSV or OUTPUTJSON
+ * @param frame
+ */
+void recordSnapshot(Print& out, uint8_t format, const smbsnapshot& frame) {
+  if (format == OUTPUTCSV) {
+    out.printf("s,%lu,%u,%lu", (unsigned long)frame.timestamp, frame.address, (unsigned long)frame.duration);
+    for (uint8_t reg = 0; reg < SNAPSHOTREGISTERS; reg++) {
+      if (frame.isValid(reg)) out.printf(",%u:%u", reg, frame.word[reg]);
+      else if (frame.code[reg]) out.printf(",%u:!%u", reg, frame.code[reg]);
+    }
+    out.println();
+  } else {
+    out.printf("{\"t\":%lu,\"addr\":%u,\"us\":%lu,\"words\":{", (unsigned long)frame.timestamp, frame.address, (unsigned long)frame.duration);
+    const char* separator = "";
+    for (uint8_t reg = 0; reg < SNAPSHOTREGISTERS; reg++) {
+      if (!frame.isValid(reg)) continue;
+      out.printf("%s\"%u\":%u", separator, reg, frame.word[reg]);
+      separator = ",";
+    }
+    out.print("},\"i2c\":{");
+    separator = "";
+    for (uint8_t reg = 0; reg < SNAPSHOTREGISTERS; reg++) {
+      if (frame.isValid(reg) || frame.code[reg] == 0) continue;
+      out.printf("%s\"%u\":%u", separator, reg, frame.code[reg]);
+      separator = ",";
+    }
+    out.println("}}");
+  }
+}
+
+/**
+ * @brief Prints a sample of the ring log.
+ * @param out
+ * @param format OUTPUTJSON, every other format prints CSV
+ * @param address
+ * @param sample
+ */
+void recordLog(Print& out, uint8_t format, uint8_t address, const logsample& sample) {
+  if (format == OUTPUTJSON) {
+    out.printf("{\"t\":%lu,\"addr\":%u", (unsigned long)sample.time, address);
+    if (sample.valid) out.printf(",\"mV\":%u,\"mA\":%d,\"dK\":%u,\"soc\":%u}\n", sample.voltage, sample.current, sample.temperature, sample.charge);
+    else out.print(",\"ok\":false}\n");
+  } else {
+    out.printf("l,%lu,%u,", (unsigned long)sample.time, address);
+    if (sample.valid) out.printf("%u,%d,%u,%u\n", sample.voltage, sample.current, sample.temperature, sample.charge);
+    else out.print("!\n");
+  }
+}
+
+/**
+ * @brief Prints the rollup of a register over a window, values in the unit of the register.
+ * @param out
+ * @param format OUTPUTJSON, every other format prints CSV
+ * @param address
+ * @param reg
+ * @param window ms
+ * @param values
+ */
+void recordRollup(Print& out, uint8_t format, uint8_t address, uint8_t reg, uint32_t window, const rollup& values) {
+  if (format == OUTPUTJSON) {
+    out.printf("{\"t\":%lu,\"addr\":%u,\"reg\":%u,\"ms\":%lu,\"n\":%lu,\"min\":%d,\"avg\":%d,\"max\":%d}\n", (unsigned long)millis(), address, reg,
+               (unsigned long)window, (unsigned long)values.count, values.min, values.average(), values.max);
+  } else {
+    out.printf("h,%lu,%u,%u,%lu,%lu,%d,%d,%d\n", (unsigned long)millis(), address, reg, (unsigned long)window, (unsigned long)values.count, values.min,
+               values.average(), values.max);
+  }
+}
+
+/**
+ * @brief Prints a sample of the triggered capture.
+ * @param out
+ * @param format OUTPUTJSON, every other format prints CSV
+ * @param address
+ * @param reg watched register
+ * @param sample
+ * @param trigger the sample which triggered
+ */
+void recordCapture(Print& out, uint8_t format, uint8_t address, uint8_t reg, const capturesample& sample, bool trigger) {
+  if (format == OUTPUTJSON) {
+    out.printf("{\"t\":%lu,\"addr\":%u,\"mV\":%u,\"mA\":%d,\"dK\":%u,\"reg\":%u,\"bits\":%lu,\"trig\":%u}\n", (unsigned long)sample.time,
+               address, sample.voltage, sample.current, sample.temperature, reg, (unsigned long)sample.watched, trigger);
+  } else {
+    out.printf("c,%lu,%u,%u,%d,%u,%u,%lu,%u\n", (unsigned long)sample.time, address, sample.voltage, sample.current, sample.temperature, reg,
+               (unsigned long)sample.watched, trigger);
+  }
+}
@@ -0,0 +1,37 @@
+/**
+ * @file records.h
+ * @author
+ * @brief Machine readable output: one CSV line or one NDJSON object per register or per snapshot, without escape
+ * sequences or padding, so a logging host can parse the serial stream line by line.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "../SMB/SMBCommands.h"
+#include "../logger/ringlog.h"
+#include "../SMB/SMBHistory.h"
+#include "../SMB/SMBCapture.h"
+
+// output formats of the display functions
+#define OUTPUTTEXT 0    /**< Aligned text with ANSI positioning, for a terminal */
+#define OUTPUTCSV  1    /**< One CSV line per record */
+#define OUTPUTJSON 2    /**< One JSON object per line (NDJSON) */
+#define OUTPUTBINARY 3  /**< COBS framed binary telemetry, see lib/telemetry/telemetry.h */
+
+#define NOREGISTER 0xff /**< A display function which does not show a single SBS register */
+
+const char* outputName(uint8_t format);
+const char* recordUnit(uint8_t reg, bool capacitymode);
+void recordWord(Print& out, uint8_t format, uint8_t address, uint8_t reg, const char* name, uint16_t raw, bool capacitymode, uint8_t code);
+void recordText(Print& out, uint8_t format, uint8_t address, uint8_t reg, const char* name, const char* text, uint8_t code);
+void recordFlags(Print& out, uint8_t format, uint8_t address, uint8_t reg, const char* name, uint32_t flags, uint32_t flipped, uint8_t code);
+void recordError(Print& out, uint8_t format, const char* name, const char* error);
+void recordSnapshot(Print& out, uint8_t format, const smbsnapshot& frame);
+void recordLog(Print& out, uint8_t format, uint8_t address, const logsample& sample);
+void recordRollup(Print& out, uint8_t format, uint8_t address, uint8_t reg, uint32_t window, const rollup& values);
+void recordCapture(Print& out, uint8_t format, uint8_t address, uint8_t reg, const capturesample& sample, bool trigger);
@@ -28,8 +28,30 @@
 //
 
 #include "i2cscanner.h"
+#include "../ansi/ansi.h"
 
-#define CLOCKSPEED 130000  /**< Roughly 100kHz */
+extern ANSI ansi;
+
+// descriptions of the i2c result codes, in flash
+static const char i2ccodes[I2CCODES][20] PROGMEM {
+    "ok",
+    "data too long",
+    "NACK on tx address",
+    "NACK on tx data",
+    "other",
+    "timeout",
+    "PEC error",
+    "wrong echo"
+};
+
+/**
+ * @brief Description of an i2c result code.
+ * @param code SMB_OK .. SMB_ECHO, other values give "other"
+ * @return const __FlashStringHelper* to print
+ */
+const __FlashStringHelper* i2cCode(uint8_t code) {
+  return FPSTR(i2ccodes[code < I2CCODES ? code : SMB_OTHER]);
+}
 
 /*
 * Nodemcu board : pin number is equal to GPIO
@@ -50,27 +72,52 @@ uint8_t i2cscan() {
 } 
 
 uint8_t i2cscan(uint8_t first, uint8_t last) {
-  Wire.begin();
-  Wire.setClock(CLOCKSPEED);
+  return i2cscan(first, last, smbus::defaultTransport());
+}
+
+uint8_t i2cscan(uint8_t first, uint8_t last, smbtransport* bus) {
   uint8_t error{0}, address{0};
-  Serial.print("Scanning from "); 
-  Serial.print(first);
-  Serial.print(" to ");
-  Serial.println(last);
+  ansi.print("Scanning from "); 
+  ansi.print(first);
+  ansi.print(" to ");
+  ansi.println(last);
   String message {""};
   for(address = first; address <= last; address++ )
   {
-    // The i2c_scanner uses the return value of the Write.endTransmisstion to see if a device did acknowledge to the address.
-    Wire.beginTransmission(address);
-    error = Wire.endTransmission();
-    Serial.print(address < 0x10 ? "0x0": "0x");
-    Serial.print(address, HEX);
-    Serial.println(" " + I2Ccode[error]);
+    // The i2c_scanner uses the return value of the transport probe to see if a device did acknowledge to the address.
+    error = bus->probe(address);
+    ansi.print(address < 0x10 ? "0x0": "0x");
+    ansi.print(address, HEX);
+    ansi.print(" ");
+    ansi.println(i2cCode(error));
     if (error == 0) break;
   }
   if (address > last) {
-    Serial.println("No I2C devices found\n");
+    ansi.println("No I2C devices found\n");
     address=0;
   }
   return address;
 }
+
+// scans the whole range and stores every address which acknowledges, returns the number found
+uint8_t i2cscanAll(uint8_t first, uint8_t last, uint8_t* found, uint8_t max, smbtransport* bus) {
+  if (bus == nullptr) bus = smbus::defaultTransport();
+  uint8_t error{0}, count{0};
+  ansi.print("Scanning from "); 
+  ansi.print(first);
+  ansi.print(" to ");
+  ansi.println(last);
+  for(uint16_t address = first; address <= last; address++ )
+  {
+    error = bus->probe(address);
+    if (error) continue;
+    ansi.print(address < 0x10 ? "0x0": "0x");
+    ansi.print(address, HEX);
+    ansi.print(" ");
+    ansi.println(i2cCode(error));
+    if (count < max) found[count] = address;
+    count++;
+  }
+  if (count == 0) ansi.println("No I2C devices found\n");
+  return count < max ? count : max;
+}
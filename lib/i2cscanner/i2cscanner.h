@@ -1,16 +1,13 @@
 #pragma once
 
 #include <Arduino.h>
-#include <Wire.h>
+#include "../SMB/SMBus.h"
 
 uint8_t i2cscan();
 uint8_t i2cscan(uint8_t, uint8_t);
+uint8_t i2cscan(uint8_t, uint8_t, smbtransport*);
+uint8_t i2cscanAll(uint8_t, uint8_t, uint8_t*, uint8_t, smbtransport* bus = nullptr);
 
-static String I2Ccode[6] {
-    "ok",
-    "data too long",
-    "NACK on tx address",
-    "NACK on tx data",
-    "other",
-    "timeout"
-};
+#define I2CCODES 8 /**< Number of i2c result codes, see SMBTransport.h */
+
+const __FlashStringHelper* i2cCode(uint8_t code);
@@ -0,0 +1,57 @@
+/**
+ * @file lineinput.cpp
+ * @author
+ * @brief Function definitions for the serial line input.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "lineinput.h"
+
+lineinput::lineinput(Stream* stream) {
+  serial = stream;
+}
+
+void lineinput::setEcho(bool echo) {
+  for (CmdBuffer<LINESIZE>& line : lines) line.setEcho(echo);
+}
+
+/**
+ * @brief Moves the available bytes into the line being typed, call it from loop(). Does not wait for more bytes.
+ * @return uint8_t number of completed lines
+ */
+uint8_t lineinput::poll() {
+  if (serial == nullptr) return count;
+  for (uint8_t n = 0; n < LINEDRAIN && serial->available(); n++) {
+    if (count == LINESLOTS - 1) { // the slot being typed in would overwrite the oldest line
+      overflows++;
+      break;
+    }
+    if (lines[tail].readSerialChar(serial)) {
+      tail = (tail + 1) % LINESLOTS;
+      count++;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief The oldest completed line, it stays valid until release().
+ * @return CmdBuffer<LINESIZE>* nullptr when no line is complete
+ */
+CmdBuffer<LINESIZE>* lineinput::next() {
+  return count ? &lines[head] : nullptr;
+}
+
+/**
+ * @brief Frees the slot of the line returned by next().
+ */
+void lineinput::release() {
+  if (count == 0) return;
+  lines[head].clear();
+  head = (head + 1) % LINESLOTS;
+  count--;
+}
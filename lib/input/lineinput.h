@@ -0,0 +1,42 @@
+/**
+ * @file lineinput.h
+ * @author
+ * @brief Non blocking line input from the serial port with type-ahead.
+ * poll() takes the bytes which are available and returns at once, it never waits for the end of a line. Completed
+ * lines are kept in a ring of CmdBuffers; the parser tokenizes a line in its slot, so the line is not copied between
+ * the serial port and the command states. Lines typed while a command is running wait in the ring and are handled
+ * in order, one per pass of loop(). When the ring is full the bytes stay in the serial buffer.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "../CmdParser/CmdBuffer.hpp"
+
+#define LINESIZE  64  /**< Longest command line */
+#define LINESLOTS 4   /**< Completed lines which can wait, plus the one being typed */
+#define LINEDRAIN 64  /**< Most bytes taken from the serial port per poll() */
+
+class lineinput {
+  public:
+  lineinput(Stream* stream = nullptr);
+  void setStream(Stream* stream) { serial = stream; };
+  void setEcho(bool echo);
+  uint8_t poll();
+  CmdBuffer<LINESIZE>* next();
+  void release();
+  uint8_t pending() { return count; };
+  uint32_t dropped() { return overflows; };
+
+  private:
+  Stream* serial;
+  CmdBuffer<LINESIZE> lines[LINESLOTS];
+  uint8_t head {0};       // oldest completed line
+  uint8_t tail {0};       // line being typed
+  uint8_t count {0};      // completed lines
+  uint32_t overflows {0}; // polls which left bytes in the serial buffer because all slots were in use
+};
@@ -0,0 +1,109 @@
+/**
+ * @file logstore.cpp
+ * @author
+ * @brief Function definitions for the log file on LittleFS and on Linux.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "logstore.h"
+
+/**
+ * @brief The store used by a ring log constructed without one, LOGFILE on LittleFS or in the working directory on Linux.
+ * @return logstore*
+ */
+logstore* logstore::defaultStore() {
+#if defined(ARDUINO)
+  static littlefsstore store;
+  return &store;
+#elif defined(__linux__)
+  static filestore store(LOGFILE + 1);
+  return &store;
+#else
+  return nullptr;
+#endif
+}
+
+#if defined(ARDUINO)
+
+littlefsstore::littlefsstore(const char* path) {
+  name = path;
+}
+
+/**
+ * @brief Mounts LittleFS and opens the file, it is created when missing.
+ * @return bool false when the file system can not be mounted
+ */
+bool littlefsstore::open() {
+  if (file) return true;
+  if (!LittleFS.begin()) return false;
+  file = LittleFS.open(name, LittleFS.exists(name) ? "r+" : "w+");
+  return (bool)file;
+}
+
+uint32_t littlefsstore::size() {
+  return file ? file.size() : 0;
+}
+
+bool littlefsstore::read(uint32_t offset, uint8_t* data, uint16_t length) {
+  if (!file || !file.seek(offset)) return false;
+  return file.read(data, length) == length;
+}
+
+// the file is flushed after every write so a page survives a reset
+bool littlefsstore::write(uint32_t offset, const uint8_t* data, uint16_t length) {
+  if (!file || !file.seek(offset)) return false;
+  bool ok = file.write(data, length) == length;
+  file.flush();
+  return ok;
+}
+
+void littlefsstore::erase() {
+  if (file) file.close();
+  LittleFS.remove(name);
+  file = LittleFS.open(name, "w+");
+}
+
+#elif defined(__linux__)
+
+filestore::filestore(const char* path) {
+  name = path;
+}
+
+filestore::~filestore() {
+  if (file) fclose(file);
+}
+
+bool filestore::open() {
+  if (file) return true;
+  file = fopen(name, "r+b");
+  if (file == nullptr) file = fopen(name, "w+b");
+  return file != nullptr;
+}
+
+uint32_t filestore::size() {
+  if (file == nullptr || fseek(file, 0, SEEK_END) != 0) return 0;
+  return ftell(file);
+}
+
+bool filestore::read(uint32_t offset, uint8_t* data, uint16_t length) {
+  if (file == nullptr || fseek(file, offset, SEEK_SET) != 0) return false;
+  return fread(data, 1, length, file) == length;
+}
+
+bool filestore::write(uint32_t offset, const uint8_t* data, uint16_t length) {
+  if (file == nullptr || fseek(file, offset, SEEK_SET) != 0) return false;
+  bool ok = fwrite(data, 1, length, file) == length;
+  fflush(file);
+  return ok;
+}
+
+void filestore::erase() {
+  if (file) fclose(file);
+  file = fopen(name, "w+b");
+}
+
+#endif
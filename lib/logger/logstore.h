@@ -0,0 +1,67 @@
+/**
+ * @file logstore.h
+ * @author
+ * @brief Storage of the ring log and of the bus sessions: a file which is read and written at an offset. On the
+ * ESP8266 the file is on LittleFS, on Linux it is a normal file so a log can be written and decoded on the host.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define LOGFILE "/ringlog.bin" /**< Name of the log file on LittleFS */
+
+class logstore {
+  public:
+  virtual ~logstore() {};
+  virtual bool open() = 0;
+  virtual uint32_t size() = 0;
+  virtual bool read(uint32_t offset, uint8_t* data, uint16_t length) = 0;
+  virtual bool write(uint32_t offset, const uint8_t* data, uint16_t length) = 0;
+  virtual void erase() = 0;
+
+  static logstore* defaultStore();
+};
+
+#if defined(ARDUINO)
+
+#include <LittleFS.h>
+
+class littlefsstore : public logstore {
+  public:
+  littlefsstore(const char* path = LOGFILE);
+  bool open();
+  uint32_t size();
+  bool read(uint32_t offset, uint8_t* data, uint16_t length);
+  bool write(uint32_t offset, const uint8_t* data, uint16_t length);
+  void erase();
+
+  private:
+  const char* name;
+  File file;
+};
+
+#elif defined(__linux__)
+
+#include <stdio.h>
+
+class filestore : public logstore {
+  public:
+  filestore(const char* path);
+  ~filestore();
+  bool open();
+  uint32_t size();
+  bool read(uint32_t offset, uint8_t* data, uint16_t length);
+  bool write(uint32_t offset, const uint8_t* data, uint16_t length);
+  void erase();
+
+  private:
+  const char* name;
+  FILE* file {nullptr};
+};
+
+#endif
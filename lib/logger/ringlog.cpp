@@ -0,0 +1,263 @@
+/**
+ * @file ringlog.cpp
+ * @author
+ * @brief Function definitions for the ring log.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ringlog.h"
+#include <string.h>
+
+static uint32_t get32(const uint8_t* data) {
+  return data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+}
+
+static void put32(uint8_t* data, uint32_t value) {
+  for (uint8_t i = 0; i < 4; i++) data[i] = value >> (8 * i);
+}
+
+/**
+ * @brief Constructor.
+ * @param store nullptr for the default store, LittleFS on the ESP8266
+ */
+ringlog::ringlog(logstore* store) {
+  this->store = store;
+}
+
+/**
+ * @brief Opens the log file and finds the newest page, the next append starts a new page after it.
+ * @return bool false when the file can not be opened
+ */
+bool ringlog::begin() {
+  if (store == nullptr) store = logstore::defaultStore();
+  if (store == nullptr || !store->open()) return false;
+  filled = store->size() / LOGPAGESIZE;
+  if (filled > LOGPAGES) filled = LOGPAGES;
+  uint32_t newest = 0;
+  bool found = false;
+  sequence = 0;
+  for (uint32_t n = 0; n < filled; n++) {
+    uint8_t header[LOGHEADER];
+    if (!store->read(n * LOGPAGESIZE, header, LOGHEADER) || header[0] != LOGMAGIC) continue;
+    uint32_t number = get32(header + 4);
+    if (!found || (int32_t)(number - sequence) > 0) {
+      sequence = number;
+      newest = n;
+      found = true;
+    }
+  }
+  current = found ? (newest + 1) % LOGPAGES : 0;
+  if (found) sequence++;
+  used = 0;
+  total = 0;
+  opened = true;
+  return true;
+}
+
+// starts a new page in RAM at the current page number
+void ringlog::startPage(uint8_t address, uint32_t time) {
+  memset(page, LOGEND, LOGPAGESIZE);
+  page[0] = LOGMAGIC;
+  page[1] = LOGVERSION;
+  page[2] = address;
+  page[3] = 0;
+  put32(page + 4, sequence);
+  put32(page + 8, time);
+  used = LOGHEADER;
+  previous = logsample();
+  previous.time = time;
+  step = 0;
+}
+
+/**
+ * @brief Adds a sample. Encodes it into the page in RAM, writes the page when the record does not fit anymore.
+ * @param address of the battery, a new address starts a new page
+ * @param sample
+ * @return bool false when the log is not open or a page could not be written
+ */
+bool ringlog::append(uint8_t address, const logsample& sample) {
+  if (!opened) return false;
+  bool ok = true;
+  if (used != 0 && (used + LOGRECORDMAX > LOGPAGESIZE || page[2] != address || page[3] == 0xff)) {
+    ok = flush();
+    current = (current + 1) % LOGPAGES;
+    sequence++;
+    used = 0;
+  }
+  if (used == 0) startPage(address, sample.time);
+
+  uint8_t* record = page + used;
+  uint8_t length = 1;
+  uint8_t mask = 0;
+  uint32_t delta = sample.time - previous.time;
+  int32_t change = (int32_t)(delta - step);
+  if (change != 0) {
+    mask |= LOGTIME;
+    length += putVarint(record + length, zigzag(change));
+  }
+  if (!sample.valid) mask |= LOGINVALID;
+  else {
+    if (sample.voltage != previous.voltage) {
+      mask |= LOGVOLTAGE;
+      length += putVarint(record + length, zigzag((int32_t)sample.voltage - previous.voltage));
+    }
+    if (sample.current != previous.current) {
+      mask |= LOGCURRENT;
+      length += putVarint(record + length, zigzag((int32_t)sample.current - previous.current));
+    }
+    if (sample.temperature != previous.temperature) {
+      mask |= LOGTEMPERATURE;
+      length += putVarint(record + length, zigzag((int32_t)sample.temperature - previous.temperature));
+    }
+    if (sample.charge != previous.charge) {
+      mask |= LOGCHARGE;
+      length += putVarint(record + length, zigzag((int32_t)sample.charge - previous.charge));
+    }
+  }
+  record[0] = mask;
+  used += length;
+  page[3]++;
+  step = delta;
+  if (sample.valid) previous = sample;
+  else previous.time = sample.time;
+  total++;
+  return ok;
+}
+
+/**
+ * @brief Writes the page in RAM, also when it is not full. A later append continues the same page.
+ * @return bool false when the write failed
+ */
+bool ringlog::flush() {
+  if (!opened || used == 0) return true;
+  if (!store->write(current * LOGPAGESIZE, page, LOGPAGESIZE)) return false;
+  pagewrites++;
+  if (current >= filled) filled = current + 1;
+  return true;
+}
+
+/**
+ * @brief Removes all pages.
+ */
+void ringlog::erase() {
+  if (store == nullptr) store = logstore::defaultStore();
+  if (store == nullptr) return;
+  store->erase();
+  filled = 0;
+  current = 0;
+  sequence = 0;
+  used = 0;
+  total = 0;
+}
+
+/**
+ * @brief Number of pages in the log, including the page in RAM.
+ * @return uint32_t
+ */
+uint32_t ringlog::pages() {
+  uint32_t n = filled;
+  if (used != 0 && current >= filled) n++;
+  return n > LOGPAGES ? LOGPAGES : n;
+}
+
+/**
+ * @brief Reads a page, 0 is the oldest. The newest page is the page in RAM.
+ * @param n
+ * @param page LOGPAGESIZE bytes
+ * @return bool false when there is no such page
+ */
+bool ringlog::readPage(uint32_t n, uint8_t* out) {
+  uint32_t count = pages();
+  if (n >= count) return false;
+  uint32_t newest = used != 0 ? current : (current + LOGPAGES - 1) % LOGPAGES;
+  uint32_t number = (newest + LOGPAGES - (count - 1 - n)) % LOGPAGES;
+  if (used != 0 && number == current) {
+    memcpy(out, page, LOGPAGESIZE);
+    return true;
+  }
+  return store->read(number * LOGPAGESIZE, out, LOGPAGESIZE) && out[0] == LOGMAGIC;
+}
+
+/**
+ * @brief Starts decoding a page.
+ * @param page
+ * @param cursor set to the first record
+ * @param address of the battery of the page
+ * @return uint8_t number of records, 0 for a page which is not a log page
+ */
+uint8_t ringlog::beginPage(const uint8_t* page, logcursor& cursor, uint8_t& address) {
+  if (page[0] != LOGMAGIC || page[1] != LOGVERSION) return 0;
+  address = page[2];
+  cursor = logcursor();
+  cursor.value.time = get32(page + 8);
+  return page[3];
+}
+
+/**
+ * @brief Decodes the next record into cursor.value.
+ * @param page
+ * @param cursor
+ * @return bool false at the end of the page
+ */
+bool ringlog::nextRecord(const uint8_t* page, logcursor& cursor) {
+  if (cursor.index >= page[3] || cursor.position >= LOGPAGESIZE || page[cursor.position] == LOGEND) return false;
+  uint8_t mask = page[cursor.position++];
+  uint32_t field = 0;
+  if (mask & LOGTIME) {
+    cursor.position += getVarint(page + cursor.position, LOGPAGESIZE - cursor.position, field);
+    cursor.step += unzigzag(field);
+  }
+  logsample& value = cursor.value;
+  value.time += cursor.step;
+  if (mask & LOGVOLTAGE) {
+    cursor.position += getVarint(page + cursor.position, LOGPAGESIZE - cursor.position, field);
+    value.voltage += unzigzag(field);
+  }
+  if (mask & LOGCURRENT) {
+    cursor.position += getVarint(page + cursor.position, LOGPAGESIZE - cursor.position, field);
+    value.current += unzigzag(field);
+  }
+  if (mask & LOGTEMPERATURE) {
+    cursor.position += getVarint(page + cursor.position, LOGPAGESIZE - cursor.position, field);
+    value.temperature += unzigzag(field);
+  }
+  if (mask & LOGCHARGE) {
+    cursor.position += getVarint(page + cursor.position, LOGPAGESIZE - cursor.position, field);
+    value.charge += unzigzag(field);
+  }
+  value.valid = !(mask & LOGINVALID);
+  cursor.index++;
+  return true;
+}
+
+/**
+ * @brief Writes a LEB128 varint.
+ * @return uint8_t bytes written, at most 5
+ */
+uint8_t ringlog::putVarint(uint8_t* out, uint32_t value) {
+  uint8_t length = 0;
+  do {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    out[length++] = byte | (value ? 0x80 : 0);
+  } while (value);
+  return length;
+}
+
+/**
+ * @brief Reads a LEB128 varint.
+ * @return uint8_t bytes read
+ */
+uint8_t ringlog::getVarint(const uint8_t* in, uint16_t length, uint32_t& value) {
+  value = 0;
+  uint8_t n = 0;
+  while (n < length && n < 5) {
+    value |= (uint32_t)(in[n] & 0x7f) << (7 * n);
+    if (!(in[n++] & 0x80)) break;
+  }
+  return n;
+}
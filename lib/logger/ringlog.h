@@ -0,0 +1,99 @@
+/**
+ * @file ringlog.h
+ * @author
+ * @brief Time series of one battery in a ring of fixed size pages in the log file.
+ * A page starts with a header (magic, version, address, records, sequence number, millis of the first record) and
+ * holds records until the next would not fit, the rest of the page is 0xff. A record is a mask byte followed by zig-zag
+ * varints of the fields which changed: the change of the time step (delta of delta of millis), voltage (mV), current
+ * (mA), temperature (0.1K) and relative state of charge (%), each as difference to the previous record of the page.
+ * The first record of a page is the difference to zero, so every page decodes on its own. Samples at a steady rate
+ * with small changes take 2 - 4 bytes.
+ * Appending only encodes into the page in RAM; the page is written when it is full, so an append costs at most one
+ * write of LOGPAGESIZE bytes. The page with the highest sequence number is the newest, begin() finds it after a reset.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include "logstore.h"
+
+#define LOGPAGESIZE   256   /**< Bytes per page, the unit of a write */
+#define LOGPAGES      3072  /**< Pages in the ring, 768 kB */
+#define LOGHEADER     12
+#define LOGMAGIC      0xb5
+#define LOGVERSION    1
+#define LOGRECORDMAX  26    /**< Mask byte and five varints of 5 bytes */
+
+// bits of the mask byte of a record
+#define LOGTIME       0x01  /**< The time step changed */
+#define LOGVOLTAGE    0x02
+#define LOGCURRENT    0x04
+#define LOGTEMPERATURE 0x08
+#define LOGCHARGE     0x10
+#define LOGINVALID    0x20  /**< The registers could not be read, the record has no values */
+#define LOGEND        0xff  /**< No more records in the page */
+
+/**
+ * @struct logsample
+ * @brief One entry of the time series.
+ */
+struct logsample {
+  uint32_t time {0};         /**< millis() */
+  uint16_t voltage {0};      /**< mV */
+  int16_t current {0};       /**< mA */
+  uint16_t temperature {0};  /**< 0.1K */
+  uint8_t charge {0};        /**< relative state of charge in % */
+  bool valid {true};
+};
+
+/**
+ * @struct logcursor
+ * @brief Position of the decoder in a page, value holds the sample of the last record read.
+ */
+struct logcursor {
+  uint16_t position {LOGHEADER};
+  uint8_t index {0};
+  uint32_t step {0};
+  logsample value;
+};
+
+class ringlog {
+  public:
+  ringlog(logstore* store = nullptr);
+  bool begin();
+  bool append(uint8_t address, const logsample& sample);
+  bool flush();
+  void erase();
+
+  bool isOpen() { return opened; };
+  uint32_t pages();
+  uint32_t records() { return total; };
+  uint32_t writes() { return pagewrites; };
+  bool readPage(uint32_t n, uint8_t* page);
+
+  static uint8_t beginPage(const uint8_t* page, logcursor& cursor, uint8_t& address);
+  static bool nextRecord(const uint8_t* page, logcursor& cursor);
+  static uint8_t putVarint(uint8_t* out, uint32_t value);
+  static uint8_t getVarint(const uint8_t* in, uint16_t length, uint32_t& value);
+  static uint32_t zigzag(int32_t value) { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); };
+  static int32_t unzigzag(uint32_t value) { return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); };
+
+  private:
+  void startPage(uint8_t address, uint32_t time);
+
+  logstore* store;
+  bool opened {false};
+  uint8_t page[LOGPAGESIZE];
+  uint16_t used {0};          // bytes of the page in RAM, 0 when no page is open
+  uint32_t current {0};       // page number of the page in RAM
+  uint32_t filled {0};        // pages in the file
+  uint32_t sequence {0};      // sequence number of the page in RAM
+  logsample previous;         // last sample of the page, the base of the next difference
+  uint32_t step {0};          // last time step
+  uint32_t total {0};         // records appended since begin()
+  uint32_t pagewrites {0};
+};
@@ -0,0 +1,361 @@
+/**
+ * @file session.cpp
+ * @author
+ * @brief Function definitions for the session recorder and the replay transport.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <Arduino.h>
+#include "session.h"
+#include "ringlog.h"
+#include "../SMB/SMBus.h"
+
+static const uint8_t sessionmagic[4] {'S', 'M', 'B', 'S'};
+
+/**
+ * @brief Encodes a record.
+ * @param out at least SESSIONRECORDMAX bytes
+ * @param record
+ * @param previous time of the record before, us
+ * @return uint8_t bytes used
+ */
+uint8_t sessionEncode(uint8_t* out, const sessionrecord& record, uint32_t previous) {
+  uint8_t length = 0;
+  out[length++] = record.kind | (record.code & 0x07) << 3;
+  length += ringlog::putVarint(out + length, record.time - previous);
+  out[length++] = record.address;
+  if (record.kind == SESSIONPROBE) return length;
+  out[length++] = record.reg;
+  if (record.kind == SESSIONREADBLOCK || record.kind == SESSIONWRITEBLOCK) {
+    uint8_t count = record.length < SESSIONBLOCKMAX ? record.length : SESSIONBLOCKMAX;
+    out[length++] = count;
+    memcpy(out + length, record.block, count);
+    return length + count;
+  }
+  out[length++] = record.word & 0xff;
+  out[length++] = record.word >> 8;
+  return length;
+}
+
+/**
+ * @brief Decodes the next record.
+ * @param in
+ * @param length bytes available
+ * @param record time holds the time of the previous record, it is replaced by the time of this one
+ * @return uint8_t bytes used, 0 when the bytes do not hold a complete record
+ */
+uint8_t sessionDecode(const uint8_t* in, uint32_t length, sessionrecord& record) {
+  if (length < 3 || in[0] & 0xc0 || (in[0] & 0x07) > SESSIONWRITEBLOCK) return 0;
+  record.kind = in[0] & 0x07;
+  record.code = in[0] >> 3 & 0x07;
+  uint32_t delta;
+  uint8_t used = 1 + ringlog::getVarint(in + 1, length > 6 ? 5 : length - 1, delta);
+  bool block = record.kind == SESSIONREADBLOCK || record.kind == SESSIONWRITEBLOCK;
+  uint8_t need = record.kind == SESSIONPROBE ? 1 : block ? 3 : 4;
+  if (used + need > length) return 0;
+  record.time += delta;
+  record.address = in[used++];
+  if (record.kind == SESSIONPROBE) return used;
+  record.reg = in[used++];
+  if (block) {
+    record.length = in[used++];
+    if (record.length > SESSIONBLOCKMAX || used + record.length > length) return 0;
+    memcpy(record.block, in + used, record.length);
+    return used + record.length;
+  }
+  record.word = in[used] | in[used + 1] << 8;
+  return used + 2;
+}
+
+/**
+ * @brief Checks the header of a session file.
+ * @param in SESSIONHEADER bytes
+ * @param pec set to the PEC setting of the recording
+ * @return bool false when it is not a session of this version
+ */
+bool sessionHeader(const uint8_t* in, bool& pec) {
+  if (memcmp(in, sessionmagic, sizeof(sessionmagic)) != 0 || in[4] != SESSIONVERSION) return false;
+  pec = in[5] != 0;
+  return true;
+}
+
+// the session file next to the ring log
+static logstore* sessionStore() {
+#if defined(ARDUINO)
+  static littlefsstore store(SESSIONFILE);
+  return &store;
+#elif defined(__linux__)
+  static filestore store(SESSIONFILE + 1);
+  return &store;
+#else
+  return nullptr;
+#endif
+}
+
+/**
+ * @brief Constructor, the recorder does not record until start().
+ * @param target transport the transactions are passed to, nullptr for the default transport at the first transaction
+ * @param store session file, nullptr for SESSIONFILE
+ */
+sessionrecorder::sessionrecorder(smbtransport* target, logstore* store) : target(target) {
+  this->store = store ? store : sessionStore();
+  if (target) pec = target->usesPec();
+}
+
+/**
+ * @brief The transport the transactions are passed to. Without one from the constructor it is the default transport
+ * when this is called first, so a global recorder does not start the bus before setup().
+ * @return smbtransport*
+ */
+smbtransport* sessionrecorder::targetTransport() {
+  if (target == nullptr) {
+    target = smbus::defaultTransport();
+    pec = target->usesPec();
+  }
+  return target;
+}
+
+/**
+ * @brief Erases the session file and starts recording.
+ * @return bool false when the file can not be opened
+ */
+bool sessionrecorder::start() {
+  if (store == nullptr || !store->open()) return false;
+  targetTransport(); // the header takes the PEC setting of the target
+  store->erase();
+  uint8_t header[SESSIONHEADER] {0};
+  memcpy(header, sessionmagic, sizeof(sessionmagic));
+  header[4] = SESSIONVERSION;
+  header[5] = pec;
+  if (!store->write(0, header, SESSIONHEADER)) return false;
+  written = SESSIONHEADER;
+  used = 0;
+  count = 0;
+  last = 0;
+  full = false;
+  started = micros();
+  recording = true;
+  return true;
+}
+
+/**
+ * @brief Stops recording and writes the records still in RAM.
+ */
+void sessionrecorder::stop() {
+  if (!recording) return;
+  flush();
+  recording = false;
+}
+
+void sessionrecorder::setPec(bool enable) {
+  targetTransport()->setPec(enable);
+  pec = enable;
+}
+
+uint8_t sessionrecorder::probe(uint8_t address) {
+  uint8_t code = targetTransport()->probe(address);
+  if (recording) {
+    sessionrecord record;
+    record.code = code;
+    record.address = address;
+    append(record);
+  }
+  return code;
+}
+
+uint8_t sessionrecorder::readWord(uint8_t address, uint8_t reg, uint16_t& data) {
+  uint8_t code = targetTransport()->readWord(address, reg, data);
+  if (recording) {
+    sessionrecord record;
+    record.kind = SESSIONREADWORD;
+    record.code = code;
+    record.address = address;
+    record.reg = reg;
+    record.word = data;
+    append(record);
+  }
+  return code;
+}
+
+uint8_t sessionrecorder::writeWord(uint8_t address, uint8_t reg, uint16_t data) {
+  uint8_t code = targetTransport()->writeWord(address, reg, data);
+  if (recording) {
+    sessionrecord record;
+    record.kind = SESSIONWRITEWORD;
+    record.code = code;
+    record.address = address;
+    record.reg = reg;
+    record.word = data;
+    append(record);
+  }
+  return code;
+}
+
+uint8_t sessionrecorder::readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length) {
+  uint8_t code = targetTransport()->readBlock(address, reg, data, length);
+  if (recording) {
+    sessionrecord record;
+    record.kind = SESSIONREADBLOCK;
+    record.code = code;
+    record.address = address;
+    record.reg = reg;
+    record.length = length < SESSIONBLOCKMAX ? length : SESSIONBLOCKMAX;
+    memcpy(record.block, data, record.length);
+    append(record);
+  }
+  return code;
+}
+
+uint8_t sessionrecorder::writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length) {
+  uint8_t code = targetTransport()->writeBlock(address, reg, data, length);
+  if (recording) {
+    sessionrecord record;
+    record.kind = SESSIONWRITEBLOCK;
+    record.code = code;
+    record.address = address;
+    record.reg = reg;
+    record.length = length < SESSIONBLOCKMAX ? length : SESSIONBLOCKMAX;
+    memcpy(record.block, data, record.length);
+    append(record);
+  }
+  return code;
+}
+
+// the target may transfer the words in one go, they are recorded as single reads with the same time
+uint8_t sessionrecorder::readWords(uint8_t address, const uint8_t* regs, uint16_t* data, uint8_t* codes, uint8_t count) {
+  uint8_t good = targetTransport()->readWords(address, regs, data, codes, count);
+  if (recording) {
+    for (uint8_t i = 0; i < count; i++) {
+      sessionrecord record;
+      record.kind = SESSIONREADWORD;
+      record.code = codes[i];
+      record.address = address;
+      record.reg = regs[i];
+      record.word = data[i];
+      append(record);
+    }
+  }
+  return good;
+}
+
+// a full file ends the recording, the records already in it stay
+void sessionrecorder::append(sessionrecord& record) {
+  record.time = micros() - started;
+  if (used + SESSIONRECORDMAX > SESSIONBUFFER) flush();
+  if (written + used + SESSIONRECORDMAX > SESSIONMAXBYTES) {
+    flush();
+    full = true;
+    recording = false;
+    return;
+  }
+  used += sessionEncode(buffer + used, record, last);
+  last = record.time;
+  count++;
+}
+
+void sessionrecorder::flush() {
+  if (used == 0) return;
+  if (store->write(written, buffer, used)) written += used;
+  used = 0;
+}
+
+#if defined(__linux__)
+
+/**
+ * @brief Reads a session file into memory and rewinds.
+ * @param store
+ * @return bool false when it is not a session file
+ */
+bool replaytransport::load(logstore& store) {
+  records.clear();
+  if (!store.open()) return false;
+  uint32_t size = store.size();
+  std::vector<uint8_t> data(size);
+  if (size < SESSIONHEADER || !store.read(0, data.data(), size) || !sessionHeader(data.data(), recordedpec)) return false;
+  sessionrecord record;
+  uint32_t position = SESSIONHEADER;
+  while (position < size) {
+    uint8_t used = sessionDecode(data.data() + position, size - position, record);
+    if (used == 0) break;
+    records.push_back(record);
+    position += used;
+  }
+  rewind();
+  return true;
+}
+
+void replaytransport::rewind() {
+  cursor = 0;
+  running = false;
+}
+
+// the next record of a transaction, the records before it are skipped
+const sessionrecord* replaytransport::match(uint8_t kind, uint8_t address, uint8_t reg) {
+  if (loop && cursor >= records.size()) rewind();
+  for (uint32_t i = cursor; i < records.size() && i < cursor + SESSIONLOOKAHEAD; i++) {
+    const sessionrecord& record = records[i];
+    if (record.kind == kind && record.address == address && (kind == SESSIONPROBE || record.reg == reg)) {
+      passed += i - cursor;
+      cursor = i + 1;
+      answered++;
+      pace(record);
+      return &record;
+    }
+  }
+  missed++;
+  return nullptr;
+}
+
+// waits until the time of the record, scaled by the speed
+void replaytransport::pace(const sessionrecord& record) {
+  if (speed <= 0) return;
+  if (!running) {
+    started = micros() - (uint32_t)(record.time / speed);
+    running = true;
+  }
+  while ((int32_t)(micros() - started - (uint32_t)(record.time / speed)) < 0) {
+  }
+}
+
+uint8_t replaytransport::probe(uint8_t address) {
+  const sessionrecord* record = match(SESSIONPROBE, address, 0);
+  return record ? record->code : SMB_NACKADDR;
+}
+
+uint8_t replaytransport::readWord(uint8_t address, uint8_t reg, uint16_t& data) {
+  const sessionrecord* record = match(SESSIONREADWORD, address, reg);
+  data = record ? record->word : 0;
+  return record ? record->code : SMB_NACKADDR;
+}
+
+uint8_t replaytransport::writeWord(uint8_t address, uint8_t reg, uint16_t data) {
+  const sessionrecord* record = match(SESSIONWRITEWORD, address, reg);
+  if (record == nullptr) return SMB_NACKADDR;
+  if (record->word != data) differed++;
+  return record->code;
+}
+
+uint8_t replaytransport::readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length) {
+  const sessionrecord* record = match(SESSIONREADBLOCK, address, reg);
+  if (record == nullptr) {
+    length = 0;
+    return SMB_NACKADDR;
+  }
+  length = record->length < length ? record->length : length;
+  memcpy(data, record->block, length);
+  return record->code;
+}
+
+uint8_t replaytransport::writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length) {
+  const sessionrecord* record = match(SESSIONWRITEBLOCK, address, reg);
+  if (record == nullptr) return SMB_NACKADDR;
+  uint8_t recorded = length < SESSIONBLOCKMAX ? length : SESSIONBLOCKMAX; // longer blocks were cut when recorded
+  if (record->length != recorded || memcmp(record->block, data, recorded) != 0) differed++;
+  return record->code;
+}
+
+#endif
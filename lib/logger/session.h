@@ -0,0 +1,149 @@
+/**
+ * @file session.h
+ * @author
+ * @brief Recording of every transaction on the bus into a session file, and on Linux a transport which answers from a
+ * recorded session, so a field issue can be reproduced and the stack benchmarked without a battery.
+ * The file starts with a header (magic "SMBS", version, PEC flag, two reserved bytes). Every transaction is a record:
+ * a kind byte (bits 0-2 the kind, bits 3-5 the i2c code), the time since the previous record in us as varint and the
+ * address. All but a probe add the register, a word transfer adds the word (little endian), a block transfer adds the
+ * number of bytes and the bytes. A word read takes 6 - 7 bytes.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include "../SMB/SMBTransport.h"
+#include "logstore.h"
+
+#define SESSIONFILE      "/session.bin" /**< Name of the session file on LittleFS */
+#define SESSIONHEADER    8
+#define SESSIONVERSION   2
+#define SESSIONBLOCKMAX  32             /**< Bytes of a block transfer which are recorded */
+#define SESSIONRECORDMAX (9 + SESSIONBLOCKMAX)
+#define SESSIONBUFFER    256            /**< Records are buffered in RAM and written in pieces of this size */
+#define SESSIONMAXBYTES  262144         /**< Recording stops when the file reaches this size */
+#define SESSIONLOOKAHEAD 64             /**< Records the replay skips to find a matching one */
+
+// kinds of transaction
+#define SESSIONPROBE     0
+#define SESSIONREADWORD  1
+#define SESSIONWRITEWORD 2
+#define SESSIONREADBLOCK 3
+#define SESSIONWRITEBLOCK 4
+
+/**
+ * @struct sessionrecord
+ * @brief One transaction of a session.
+ */
+struct sessionrecord {
+  uint32_t time {0};      /**< us since the start of the session */
+  uint8_t kind {SESSIONPROBE};
+  uint8_t code {SMB_OK};  /**< i2c code of the transaction */
+  uint8_t address {0};
+  uint8_t reg {0};
+  uint16_t word {0};      /**< word read or written */
+  uint8_t length {0};     /**< bytes of a block transfer */
+  uint8_t block[SESSIONBLOCKMAX];
+};
+
+uint8_t sessionEncode(uint8_t* out, const sessionrecord& record, uint32_t previous);
+uint8_t sessionDecode(const uint8_t* in, uint32_t length, sessionrecord& record);
+bool sessionHeader(const uint8_t* in, bool& pec);
+
+/**
+ * @class sessionrecorder
+ * @brief A transport between the stack and the real transport. It passes every transaction on, and while recording
+ * it appends them to the session file.
+ */
+class sessionrecorder : public smbtransport {
+  public:
+  sessionrecorder(smbtransport* target = nullptr, logstore* store = nullptr);
+  bool start();
+  void stop();
+  bool isRecording() { return recording; };
+  bool isFull() { return full; };
+  uint32_t records() { return count; };
+  uint32_t bytes() { return written + used; };
+  logstore* file() { return store; };
+  smbtransport* targetTransport();
+
+  void setPec(bool enable);
+  uint8_t probe(uint8_t address);
+  uint8_t readWord(uint8_t address, uint8_t reg, uint16_t& data);
+  uint8_t writeWord(uint8_t address, uint8_t reg, uint16_t data);
+  uint8_t readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length);
+  uint8_t writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length);
+  uint8_t readWords(uint8_t address, const uint8_t* regs, uint16_t* data, uint8_t* codes, uint8_t count);
+
+  private:
+  void append(sessionrecord& record);
+  void flush();
+
+  smbtransport* target;
+  logstore* store;
+  bool recording {false};
+  bool full {false};
+  uint8_t buffer[SESSIONBUFFER];
+  uint16_t used {0};       // bytes in buffer
+  uint32_t written {0};    // bytes in the file
+  uint32_t started {0};    // micros() of start()
+  uint32_t last {0};       // time of the previous record, us since start
+  uint32_t count {0};
+};
+
+#if defined(__linux__)
+
+#include <vector>
+
+/**
+ * @class replaytransport
+ * @brief Answers the transactions from a recorded session. A transaction takes the next record of the same kind,
+ * address and register within SESSIONLOOKAHEAD records, so a replay which reads less (register cache, a shorter
+ * command) stays in step; without a match it fails with SMB_NACKADDR. A write takes its record even when the data
+ * differs from the recording, differences() counts those. With a speed the answers are paced like the recording
+ * (2 is twice as fast), by default they come at once.
+ */
+class replaytransport : public smbtransport {
+  public:
+  bool load(logstore& store);
+  void rewind();
+  void setSpeed(float factor) { speed = factor; };
+  void setLoop(bool enable) { loop = enable; };
+  uint32_t size() { return records.size(); };
+  uint32_t position() { return cursor; };
+  uint32_t duration() { return records.empty() ? 0 : records.back().time; };
+  uint32_t replayed() { return answered; };
+  uint32_t skipped() { return passed; };
+  uint32_t misses() { return missed; };
+  uint32_t differences() { return differed; };
+  bool recordedPec() { return recordedpec; };
+  const sessionrecord& record(uint32_t index) { return records[index]; };
+
+  uint8_t probe(uint8_t address);
+  uint8_t readWord(uint8_t address, uint8_t reg, uint16_t& data);
+  uint8_t writeWord(uint8_t address, uint8_t reg, uint16_t data);
+  uint8_t readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint8_t& length);
+  uint8_t writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length);
+
+  private:
+  const sessionrecord* match(uint8_t kind, uint8_t address, uint8_t reg);
+  void pace(const sessionrecord& record);
+
+  std::vector<sessionrecord> records;
+  uint32_t cursor {0};     // next record
+  float speed {0};
+  bool loop {false};
+  bool recordedpec {false};
+  uint32_t started {0};    // micros() of the first answer
+  bool running {false};
+  uint32_t answered {0};
+  uint32_t passed {0};
+  uint32_t missed {0};
+  uint32_t differed {0};   // writes with other data than the recording
+};
+
+#endif
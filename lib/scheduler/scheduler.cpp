@@ -0,0 +1,126 @@
+/**
+ * @file scheduler.cpp
+ * @author
+ * @brief Function definitions for the timer wheel of recurring jobs.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "scheduler.h"
+
+scheduler::scheduler() {
+  clear();
+}
+
+/**
+ * @brief Registers a job, the first run is one period from now.
+ * @param type schedulejob::CATEGORY, NAME or SNAPSHOT
+ * @param arg category or command index
+ * @param period in ms, at least WHEELTICKMS
+ * @param now millis()
+ * @return int8_t id of the job, -1 when all jobs are in use
+ */
+int8_t scheduler::add(uint8_t type, uint8_t arg, uint32_t period, uint32_t now) {
+  if (type == schedulejob::FREE) return -1;
+  for (uint8_t id = 0; id < SCHEDULERJOBS; id++) {
+    if (jobs[id].type != schedulejob::FREE) continue;
+    if (!started) {
+      tick = 0;
+      last = now;
+      started = true;
+    }
+    jobs[id] = schedulejob();
+    jobs[id].type = type;
+    jobs[id].arg = arg;
+    jobs[id].period = period < WHEELTICKMS ? WHEELTICKMS : period;
+    jobs[id].due = now + jobs[id].period;
+    insert(id);
+    return id;
+  }
+  return -1;
+}
+
+/**
+ * @brief Removes a job.
+ * @param id
+ * @return bool false when there is no such job
+ */
+bool scheduler::remove(uint8_t id) {
+  if (id >= SCHEDULERJOBS || jobs[id].type == schedulejob::FREE) return false;
+  if (ready & (1 << id)) ready &= ~(1 << id);
+  else unlink(id);
+  jobs[id].type = schedulejob::FREE;
+  return true;
+}
+
+void scheduler::clear() {
+  for (schedulejob& job : jobs) job = schedulejob();
+  for (uint8_t& slot : slots) slot = NOJOB;
+  ready = 0;
+  started = false;
+}
+
+/**
+ * @brief Turns the wheel to now and returns one job which is due, call it from loop().
+ * The job is rescheduled and its statistics are updated, the caller runs it.
+ * @param now millis()
+ * @return int8_t id of the job to run, -1 when none is due
+ */
+int8_t scheduler::poll(uint32_t now) {
+  if (!started) return -1;
+  uint32_t ticks = (now - last) / WHEELTICKMS;
+  last += ticks * WHEELTICKMS;
+  uint32_t visit = ticks > WHEELSLOTS ? WHEELSLOTS : ticks; // after a long pause every slot is looked at once
+  for (uint32_t n = 1; n <= visit; n++) {
+    uint8_t* link = &slots[(tick + ticks - visit + n) % WHEELSLOTS];
+    while (*link != NOJOB) {
+      uint8_t id = *link;
+      if ((int32_t)(jobs[id].due - now) <= 0) { // due, off the wheel into the ready set
+        *link = jobs[id].next;
+        ready |= 1 << id;
+      } else link = &jobs[id].next; // due in a later turn
+    }
+  }
+  tick += ticks;
+  if (ready == 0) return -1;
+
+  uint8_t id = 0;
+  for (uint8_t i = 0; i < SCHEDULERJOBS; i++) { // the job which waits longest
+    if ((ready & (1 << i)) && (!(ready & (1 << id)) || (int32_t)(jobs[i].due - jobs[id].due) < 0)) id = i;
+  }
+  ready &= ~(1 << id);
+  schedulejob& job = jobs[id];
+  uint32_t late = now - job.due;
+  job.runs++;
+  job.jittersum += late;
+  if (late > job.jittermax) job.jittermax = late;
+  uint32_t skipped = late / job.period;
+  job.overruns += skipped;
+  job.due += job.period * (skipped + 1);
+  insert(id);
+  return id;
+}
+
+uint8_t scheduler::count() {
+  uint8_t n = 0;
+  for (const schedulejob& job : jobs) if (job.type != schedulejob::FREE) n++;
+  return n;
+}
+
+// puts a job in the slot of the first tick which starts at or after its due time, at least the next tick
+void scheduler::insert(uint8_t id) {
+  int32_t ahead = (int32_t)(jobs[id].due - last);
+  uint32_t ticks = ahead <= WHEELTICKMS ? 1 : (ahead + WHEELTICKMS - 1) / WHEELTICKMS;
+  jobs[id].slot = (tick + ticks) % WHEELSLOTS;
+  jobs[id].next = slots[jobs[id].slot];
+  slots[jobs[id].slot] = id;
+}
+
+void scheduler::unlink(uint8_t id) {
+  uint8_t* link = &slots[jobs[id].slot];
+  while (*link != NOJOB && *link != id) link = &jobs[*link].next;
+  if (*link == id) *link = jobs[id].next;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file scheduler.h
+ * @author
+ * @brief Recurring jobs (a category, a named command or a snapshot at a fixed interval) kept in a timer wheel.
+ * The wheel has WHEELSLOTS slots of WHEELTICKMS each; a job hangs in the slot of its due tick, so poll() only looks
+ * at the slots of the ticks which passed since the previous call instead of at every job. A job further away than one
+ * turn of the wheel stays in its slot until its turn. poll() hands out at most one due job per call, so the jobs share
+ * loop() with the serial input. Every job keeps its run count, overruns (periods skipped because it was too late) and
+ * the jitter (how late it ran).
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define SCHEDULERJOBS 8   /**< Number of recurring jobs */
+#define WHEELSLOTS    32  /**< Slots of the timer wheel */
+#define WHEELTICKMS   10  /**< Resolution of the timer wheel, one turn is WHEELSLOTS * WHEELTICKMS ms */
+#define NOJOB         0xff
+
+/**
+ * @struct schedulejob
+ * @brief One recurring job with its statistics.
+ */
+struct schedulejob {
+  enum {
+    FREE = 0,   /**< Slot is unused */
+    CATEGORY,   /**< displayByClassifier(arg) */
+    NAME,       /**< displayByIndex(arg), arg is the index in the command table */
+    SNAPSHOT,   /**< displaySnapshot() */
+    LOG,        /**< sample into the ring log (command 12) */
+    HISTORY,    /**< sample into the rollups in RAM (command 13) */
+    CAPTURE,    /**< sample into the armed trigger capture (command 14) */
+  };
+  uint8_t type {FREE};
+  uint8_t arg {0};
+  uint32_t period {0};      /**< ms */
+  uint32_t due {0};         /**< millis() of the next run */
+  uint32_t runs {0};
+  uint32_t overruns {0};    /**< periods skipped because the job ran more than a period late */
+  uint32_t jittermax {0};   /**< ms the job ran late at most */
+  uint32_t jittersum {0};   /**< ms late summed over all runs, divide by runs for the mean */
+  uint8_t slot {0};         /**< wheel slot the job hangs in */
+  uint8_t next {NOJOB};     /**< next job in the same wheel slot */
+};
+
+class scheduler {
+  public:
+  scheduler();
+  int8_t add(uint8_t type, uint8_t arg, uint32_t period, uint32_t now);
+  bool remove(uint8_t id);
+  void clear();
+  int8_t poll(uint32_t now);
+  uint8_t count();
+  const schedulejob& job(uint8_t id) { return jobs[id]; };
+
+  private:
+  void insert(uint8_t id);
+  void unlink(uint8_t id);
+
+  schedulejob jobs[SCHEDULERJOBS];
+  uint8_t slots[WHEELSLOTS];  // first job of every slot
+  uint32_t tick {0};          // ticks since the first job, the slot of a tick is tick % WHEELSLOTS
+  uint32_t last {0};          // millis() of the start of the current tick
+  uint8_t ready {0};          // bit per job which is due and waits for its turn
+  bool started {false};
+};
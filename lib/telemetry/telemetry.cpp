@@ -0,0 +1,251 @@
+/**
+ * @file telemetry.cpp
+ * @author
+ * @brief Function definitions for the binary telemetry frames.
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "telemetry.h"
+#include <string.h>
+
+// telemetrycrctable[n] is the CRC-16/CCITT (polynomial 0x1021) of the single byte n
+const uint16_t telemetrycrctable[256] {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+  0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+  0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6,
+  0x9339, 0x8318, 0xb37b, 0xa35a, 0xd3bd, 0xc39c, 0xf3ff, 0xe3de,
+  0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485,
+  0xa56a, 0xb54b, 0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d,
+  0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
+  0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc,
+  0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861, 0x2802, 0x3823,
+  0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b,
+  0x5af5, 0x4ad4, 0x7ab7, 0x6a96, 0x1a71, 0x0a50, 0x3a33, 0x2a12,
+  0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a,
+  0x6ca6, 0x7c87, 0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41,
+  0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
+  0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70,
+  0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a, 0x9f59, 0x8f78,
+  0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f,
+  0x1080, 0x00a1, 0x30c2, 0x20e3, 0x5004, 0x4025, 0x7046, 0x6067,
+  0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e,
+  0x02b1, 0x1290, 0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256,
+  0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
+  0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+  0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e, 0xc71d, 0xd73c,
+  0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634,
+  0xd94c, 0xc96d, 0xf90e, 0xe92f, 0x99c8, 0x89e9, 0xb98a, 0xa9ab,
+  0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3,
+  0xcb7d, 0xdb5c, 0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a,
+  0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
+  0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9,
+  0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83, 0x1ce0, 0x0cc1,
+  0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
+  0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0,
+};
+
+/**
+ * @brief CRC-16/CCITT-FALSE, one table lookup per byte.
+ * @param data
+ * @param length
+ * @param crc running CRC, TELEMETRYCRCINIT at the start
+ * @return uint16_t
+ */
+uint16_t telemetryCrc(const uint8_t* data, uint16_t length, uint16_t crc) {
+  for (uint16_t i = 0; i < length; i++) crc = (crc << 8) ^ telemetrycrctable[(crc >> 8) ^ data[i]];
+  return crc;
+}
+
+/**
+ * @brief Consistent overhead byte stuffing: removes all 0x00 bytes, so 0x00 can end a frame.
+ * @param data
+ * @param length
+ * @param out at least length + length / 254 + 1 bytes
+ * @return uint16_t length of the encoded data, without delimiter
+ */
+uint16_t cobsEncode(const uint8_t* data, uint16_t length, uint8_t* out) {
+  uint16_t code = 0, write = 1;
+  uint8_t run = 1;
+  for (uint16_t i = 0; i < length; i++) {
+    if (data[i] == 0) {
+      out[code] = run;
+      code = write++;
+      run = 1;
+      continue;
+    }
+    out[write++] = data[i];
+    if (++run == 0xff) {
+      out[code] = run;
+      code = write++;
+      run = 1;
+    }
+  }
+  out[code] = run;
+  return write;
+}
+
+/**
+ * @brief Reverses cobsEncode.
+ * @param data encoded bytes, without delimiter
+ * @param length
+ * @param out at least length bytes
+ * @return uint16_t length of the decoded data, 0 when the data is not valid COBS
+ */
+uint16_t cobsDecode(const uint8_t* data, uint16_t length, uint8_t* out) {
+  uint16_t read = 0, write = 0;
+  while (read < length) {
+    uint8_t code = data[read++];
+    if (code == 0 || read + code - 1 > length) return 0;
+    for (uint8_t i = 1; i < code; i++) out[write++] = data[read++];
+    if (code != 0xff && read < length) out[write++] = 0;
+  }
+  return write;
+}
+
+/**
+ * @brief Starts a frame.
+ * @param type TELEMETRYSNAPSHOT or TELEMETRYREGISTER
+ * @param address of the battery
+ * @param timestamp millis()
+ * @param duration read time in us
+ */
+void telemetryencoder::begin(uint8_t type, uint8_t address, uint32_t timestamp, uint32_t duration) {
+  if (duration > 0xffff) duration = 0xffff;
+  payload[0] = TELEMETRYVERSION;
+  payload[1] = type;
+  payload[2] = sequence;
+  payload[3] = sequence >> 8;
+  memcpy(&payload[4], &timestamp, 4); // little endian on the ESP8266 and the hosts
+  payload[8] = duration;
+  payload[9] = duration >> 8;
+  payload[10] = address;
+  payload[11] = 0;
+  length = TELEMETRYHEADER;
+  sequence++;
+}
+
+/**
+ * @brief Adds a register, a failed read is stored with its i2c code only.
+ * @param reg
+ * @param word
+ * @param code
+ */
+void telemetryencoder::add(uint8_t reg, uint16_t word, uint8_t code) {
+  if (payload[11] == TELEMETRYENTRIES) return;
+  payload[11]++;
+  if (code) {
+    payload[length++] = reg | TELEMETRYERROR;
+    payload[length++] = code;
+  } else {
+    payload[length++] = reg;
+    payload[length++] = word;
+    payload[length++] = word >> 8;
+  }
+}
+
+/**
+ * @brief Appends the CRC and encodes the frame.
+ * @param out at least TELEMETRYFRAME bytes
+ * @return uint16_t number of bytes to send, including the 0x00 delimiters
+ */
+uint16_t telemetryencoder::end(uint8_t* out) {
+  uint16_t crc = telemetryCrc(payload, length);
+  payload[length++] = crc;
+  payload[length++] = crc >> 8;
+  out[0] = 0;   // text printed before the frame ends at this delimiter, not in the frame
+  uint16_t size = cobsEncode(payload, length, out + 1) + 1;
+  out[size++] = 0;
+  return size;
+}
+
+/**
+ * @brief Encodes all registers of a snapshot which were read.
+ * @param frame
+ * @param out at least TELEMETRYFRAME bytes
+ * @return uint16_t number of bytes to send
+ */
+uint16_t telemetryencoder::encode(const smbsnapshot& frame, uint8_t* out) {
+  begin(TELEMETRYSNAPSHOT, frame.address, frame.timestamp, frame.duration);
+  for (uint8_t reg = 0; reg < SNAPSHOTREGISTERS; reg++) {
+    if (frame.isValid(reg) || frame.code[reg]) add(reg, frame.word[reg], frame.code[reg]);
+  }
+  return end(out);
+}
+
+// bytes between two 0x00 which decode to a header of a known version and type are a frame, a damaged one fails the CRC
+static bool isFrame(const uint8_t* payload, uint16_t size) {
+  return size >= TELEMETRYHEADER + 2 && payload[0] == TELEMETRYVERSION &&
+         (payload[1] == TELEMETRYSNAPSHOT || payload[1] == TELEMETRYREGISTER);
+}
+
+/**
+ * @brief Feeds one received byte.
+ * @param data
+ * @return true when a frame is complete and valid, see record()
+ */
+bool telemetrydecoder::feed(uint8_t data) {
+  if (data != 0) {
+    if (length < TELEMETRYFRAME) buffer[length++] = data;
+    else {
+      overflow = true;
+      ignored++;
+    }
+    return false;
+  }
+  uint8_t payload[TELEMETRYFRAME];
+  uint16_t size = overflow ? 0 : cobsDecode(buffer, length, payload);
+  bool ok = false;
+  if (isFrame(payload, size)) ok = parse(payload, size);
+  else ignored += length; // text between the frames, f.e. the echo of a command
+  length = 0;
+  overflow = false;
+  return ok;
+}
+
+/**
+ * @brief Checks the CRC and unpacks a decoded frame, the header is checked by isFrame().
+ * @param payload
+ * @param size
+ * @return true if valid
+ */
+bool telemetrydecoder::parse(const uint8_t* payload, uint16_t size) {
+  if (telemetryCrc(payload, size - 2) != (payload[size - 2] | payload[size - 1] << 8)) {
+    crcerrors++;
+    return false;
+  }
+  telemetryrecord record;
+  record.type = payload[1];
+  record.sequence = payload[2] | payload[3] << 8;
+  memcpy(&record.timestamp, &payload[4], 4);
+  record.duration = payload[8] | payload[9] << 8;
+  record.address = payload[10];
+  record.count = 0;
+  uint16_t i = TELEMETRYHEADER;
+  for (uint8_t n = 0; n < payload[11] && n < TELEMETRYENTRIES; n++) {
+    if (i >= size - 2) break;
+    uint8_t reg = payload[i++];
+    record.reg[n] = reg & ~TELEMETRYERROR;
+    if (reg & TELEMETRYERROR) {
+      record.word[n] = 0;
+      record.code[n] = payload[i++];
+    } else {
+      record.word[n] = payload[i] | payload[i + 1] << 8;
+      record.code[n] = 0;
+      i += 2;
+    }
+    record.count++;
+  }
+  if (i != size - 2) {
+    crcerrors++; // the entries do not fill the frame
+    return false;
+  }
+  if (synced) missing += (uint16_t)(record.sequence - current.sequence - 1);
+  synced = true;
+  current = record;
+  good++;
+  return true;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file telemetry.h
+ * @author
+ * @brief Binary telemetry frames: a snapshot packed as register id, raw word and i2c code, with a sequence number and a
+ * CRC-16, framed with COBS so a 0x00 byte always ends a frame. A frame also starts with 0x00, so text in between is dropped. A receiver which starts in the middle of the stream or
+ * loses bytes syncs again at the next 0x00. telemetrydecoder turns the stream back into records, it has no Arduino
+ * dependencies besides the snapshot definition and is used on the host as well.
+ *
+ * Frame before COBS, little endian:
+ *   version, type, sequence (2), millis (4), read time in us (2), address, number of entries,
+ *   entries: register, word (2)          register | TELEMETRYERROR, i2c code
+ *   CRC-16/CCITT (2) over all previous bytes
+ * @version 1.0
+ * @date 10-2026
+ *
+ * @copyright
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include "../SMB/SMBCommands.h"
+
+#define TELEMETRYVERSION   1
+#define TELEMETRYSNAPSHOT  1    /**< Frame type: a snapshot of one battery */
+#define TELEMETRYREGISTER  2    /**< Frame type: registers shown by a display command */
+#define TELEMETRYERROR     0x80 /**< Set in the register id of an entry which holds an i2c code instead of a word */
+#define TELEMETRYHEADER    12
+#define TELEMETRYENTRIES   SNAPSHOTREGISTERS
+#define TELEMETRYPAYLOAD   (TELEMETRYHEADER + 3 * TELEMETRYENTRIES + 2)     /**< Longest frame before COBS */
+#define TELEMETRYFRAME     (TELEMETRYPAYLOAD + TELEMETRYPAYLOAD / 254 + 3)  /**< Longest frame with COBS and both delimiters */
+#define TELEMETRYCRCINIT   0xffff
+
+extern const uint16_t telemetrycrctable[256];
+
+uint16_t telemetryCrc(const uint8_t* data, uint16_t length, uint16_t crc = TELEMETRYCRCINIT);
+uint16_t cobsEncode(const uint8_t* data, uint16_t length, uint8_t* out);
+uint16_t cobsDecode(const uint8_t* data, uint16_t length, uint8_t* out);
+
+/**
+ * @struct telemetryrecord
+ * @brief A decoded frame.
+ */
+struct telemetryrecord {
+  uint8_t type;
+  uint16_t sequence;
+  uint32_t timestamp;                  /**< millis() of the sender */
+  uint16_t duration;                   /**< Read time in us, 65535 when longer */
+  uint8_t address;
+  uint8_t count;                       /**< Number of entries */
+  uint8_t reg[TELEMETRYENTRIES];
+  uint16_t word[TELEMETRYENTRIES];     /**< 0 when the read failed */
+  uint8_t code[TELEMETRYENTRIES];      /**< i2c code */
+};
+
+class telemetryencoder {
+  public:
+  void begin(uint8_t type, uint8_t address, uint32_t timestamp, uint32_t duration);
+  void add(uint8_t reg, uint16_t word, uint8_t code);
+  uint16_t end(uint8_t* out);
+  uint16_t encode(const smbsnapshot& frame, uint8_t* out);
+
+  private:
+  uint8_t payload[TELEMETRYPAYLOAD];
+  uint16_t length {0};
+  uint16_t sequence {0};
+};
+
+class telemetrydecoder {
+  public:
+  bool feed(uint8_t data);
+  const telemetryrecord& record() { return current; };
+  uint32_t frames() { return good; };
+  uint32_t crcErrors() { return crcerrors; };
+  uint32_t skipped() { return ignored; };
+  uint32_t lost() { return missing; };
+
+  private:
+  bool parse(const uint8_t* payload, uint16_t length);
+
+  uint8_t buffer[TELEMETRYFRAME];
+  uint16_t length {0};
+  bool overflow {false};
+  bool synced {false};      // a sequence number was seen, gaps can be counted
+  telemetryrecord current;
+  uint32_t good {0};
+  uint32_t crcerrors {0};
+  uint32_t ignored {0};     // bytes which are no frame, f.e. text between the frames
+  uint32_t missing {0};     // frames lost according to the sequence numbers
+};
@@ -0,0 +1,77 @@
+"""
+RAM report of the firmware.
+
+Sums the sections which end up in RAM (.data, .rodata and .bss, on the ESP8266 .rodata is copied to RAM at boot) and
+compares them with the baseline in scripts/ram_baseline.json, so a change which moves tables to or from flash shows up
+after every build.
+
+As PlatformIO extra script (platformio.ini: extra_scripts = post:scripts/ram_report.py) it runs after the link.
+Stand alone:
+  python scripts/ram_report.py .pio/build/nodemcuv2/firmware.elf [--save] [--size xtensa-lx106-elf-size]
+--save stores the current numbers as the new baseline. The repository has no baseline, it depends on the toolchain and
+the library versions of the build; create one from the firmware before a change to see what the change saves.
+"""
+
+import json
+import os
+import subprocess
+import sys
+
+SECTIONS = (".data", ".rodata", ".bss")
+
+
+def sections(sizetool, elf):
+    """Returns {section: bytes} for the RAM sections, parsed from `size -A`."""
+    output = subprocess.check_output([sizetool, "-A", elf], universal_newlines=True)
+    result = dict.fromkeys(SECTIONS, 0)
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0] in result and fields[1].isdigit():
+            result[fields[0]] += int(fields[1])
+    return result
+
+
+def report(current, baseline_path, save):
+    baseline = {}
+    if os.path.exists(baseline_path):
+        with open(baseline_path) as f:
+            baseline = json.load(f)
+    print("RAM usage      bytes   baseline     delta")
+    for name in SECTIONS + ("total",):
+        value = current[name] if name != "total" else sum(current[s] for s in SECTIONS)
+        if name in baseline:
+            print("%-10s %9d  %9d  %+8d" % (name, value, baseline[name], value - baseline[name]))
+        else:
+            print("%-10s %9d          -         -" % (name, value))
+    if not baseline and not save:
+        print("no baseline in " + baseline_path + ": build the commit before the change and run this script with --save")
+        print("on its firmware.elf, the builds after it then show the RAM saved")
+    if save:
+        current = dict(current, total=sum(current[s] for s in SECTIONS))
+        with open(baseline_path, "w") as f:
+            json.dump(current, f, indent=2, sort_keys=True)
+        print("baseline saved to " + baseline_path)
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__)
+        return 1
+    sizetool = "size"
+    if "--size" in argv:
+        sizetool = argv[argv.index("--size") + 1]
+    baseline = os.path.join(os.path.dirname(os.path.abspath(argv[0])), "ram_baseline.json")
+    report(sections(sizetool, argv[1]), baseline, "--save" in argv)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
+else:
+    Import("env")  # noqa: F821, provided by PlatformIO
+
+    def after_build(source, target, env):
+        baseline = os.path.join(env.subst("$PROJECT_DIR"), "scripts", "ram_baseline.json")
+        report(sections(env.subst("$SIZETOOL"), str(target[0])), baseline, False)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", after_build)  # noqa: F821
@@ -11,22 +11,23 @@
 
 #include <Arduino.h>
 #include "../lib/FiniteStateMachine/fsm.h"
-#include "../lib/CmdParser/CmdBuffer.hpp"
-#include "../lib/CmdParser/CmdParser.hpp"
+#include "../lib/input/lineinput.h"
 
 Command command;
-CmdBuffer<64> cmdBuffer;
+lineinput input(&Serial);
 
 void setup() {
   Serial.begin(115200);
-  cmdBuffer.setEcho(true);
+  input.setEcho(true);
   command.update();
 }
 
 void loop() {
-  if (cmdBuffer.readFromSerial(&Serial, 1)) {
-      command.handleInput(cmdBuffer);
-      cmdBuffer.clear();
+  input.poll(); // takes what has arrived, does not wait for the end of the line
+  CmdBuffer<LINESIZE>* line = input.next();
+  if (line) {
+      command.handleInput(*line); // parsed in place
+      input.release();
   }
   command.update();
 }